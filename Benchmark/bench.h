@@ -0,0 +1,413 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Shared benchmark harness for the kernel drivers.
+//
+// Run without arguments, a driver keeps its interactive prompts. Any
+// argument switches it to benchmark mode, where every parameter comes from
+// the command line or a config file and nothing is read from cin:
+//
+//   ./bfs --sizes=100000,1000000 --threads=1,2,4,8 --reps=10 --json=bfs.json
+//   ./bfs --config=bfs.cfg          (one key=value per line, # comments)
+//
+// Common options (drivers add their own, see --help):
+//   --warmup=N        untimed runs before measuring (default 1)
+//   --reps=N          timed repetitions per configuration (default 5)
+//   --threads=LIST    thread counts to sweep (default 1,2,4,... up to max)
+//   --sizes=LIST      problem sizes to sweep
+//   --scaling=MODE    strong (size fixed) or weak (work x threads)
+//   --json=PATH       write results as JSON
+//   --csv=PATH        write results as CSV
+//
+// Each configuration reports min/median/mean/p95/stddev at nanosecond
+// resolution, the speedup over the sequential variant of the same size, and
+// the parallel efficiency. Strong scaling: speedup / threads. Weak scaling:
+// T(1 thread, base size) / T(t threads, scaled size) of the same variant,
+// because the sequential baseline's work need not grow like the kernel's.
+// Sequential variants ("seq" and "seq_*") have no efficiency.
+//
+// Weak scaling grows the size so that the work, not the size, is
+// proportional to the thread count. A kernel whose work is size^k passes
+// work_exponent = k (matrix multiplication 3) and gets size * threads^(1/k).
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+namespace bench {
+
+class Options {
+public:
+    Options(int argc, char* argv[]) : interactive_(argc <= 1) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                errors_.push_back("unexpected argument '" + arg + "'");
+                continue;
+            }
+            arg = arg.substr(2);
+            size_t eq = arg.find('=');
+            if (eq != std::string::npos) {
+                values_[arg.substr(0, eq)] = arg.substr(eq + 1);
+            } else if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+                values_[arg] = argv[++i];
+            } else {
+                values_[arg] = "1"; // flag
+            }
+        }
+        if (has("config")) load_config(get_string("config", ""));
+    }
+
+    // True when started without arguments: drivers keep their prompts
+    bool interactive() const { return interactive_; }
+
+    bool has(const std::string& key) const { return values_.count(key) > 0; }
+
+    std::string get_string(const std::string& key, const std::string& def) const {
+        auto it = values_.find(key);
+        return it == values_.end() ? def : it->second;
+    }
+
+    long long get_int(const std::string& key, long long def) const {
+        auto it = values_.find(key);
+        if (it == values_.end()) return def;
+        try {
+            size_t used = 0;
+            long long v = std::stoll(it->second, &used);
+            if (used == it->second.size()) return v;
+        } catch (...) {
+        }
+        errors_.push_back("--" + key + " expects an integer, got '" + it->second + "'");
+        return def;
+    }
+
+    // Comma separated integers
+    std::vector<long long> get_list(const std::string& key, const std::vector<long long>& def) const {
+        auto it = values_.find(key);
+        if (it == values_.end()) return def;
+        std::vector<long long> list;
+        std::stringstream ss(it->second);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            try {
+                size_t used = 0;
+                list.push_back(std::stoll(item, &used));
+                if (used != item.size()) throw 0;
+            } catch (...) {
+                errors_.push_back("--" + key + " expects a comma separated list of integers, got '" + it->second + "'");
+                return def;
+            }
+        }
+        return list;
+    }
+
+    // Records an error for every option not in `known`
+    void check_known(const std::set<std::string>& known) const {
+        for (const auto& kv : values_) {
+            if (!known.count(kv.first)) errors_.push_back("unknown option --" + kv.first);
+        }
+    }
+
+    void error(const std::string& message) const { errors_.push_back(message); }
+
+    // Prints collected errors; true if there were any
+    bool report_errors() const {
+        for (const auto& e : errors_) std::cerr << "Error: " << e << "\n";
+        return !errors_.empty();
+    }
+
+private:
+    void load_config(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            errors_.push_back("cannot open config file '" + path + "'");
+            return;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            line = line.substr(0, line.find('#'));
+            size_t eq = line.find('=');
+            if (eq == std::string::npos) continue;
+            std::string key = trim(line.substr(0, eq));
+            if (key.rfind("--", 0) == 0) key = key.substr(2);
+            // Command line values take precedence over the file
+            if (!key.empty() && !values_.count(key)) values_[key] = trim(line.substr(eq + 1));
+        }
+    }
+
+    static std::string trim(const std::string& s) {
+        size_t b = s.find_first_not_of(" \t\r");
+        size_t e = s.find_last_not_of(" \t\r");
+        return b == std::string::npos ? "" : s.substr(b, e - b + 1);
+    }
+
+    bool interactive_;
+    std::map<std::string, std::string> values_;
+    mutable std::vector<std::string> errors_;
+};
+
+// Summary of repeated timings, in seconds
+struct Stats {
+    int reps = 0;
+    double min = 0, median = 0, mean = 0, p95 = 0, stddev = 0;
+
+    static Stats from(std::vector<double> samples) {
+        Stats s;
+        s.reps = (int)samples.size();
+        if (samples.empty()) return s;
+        std::sort(samples.begin(), samples.end());
+        const size_t n = samples.size();
+        s.min = samples.front();
+        s.median = n % 2 ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+        // Nearest-rank percentile
+        s.p95 = samples[std::min(n - 1, (size_t)std::ceil(0.95 * n) - 1)];
+        double sum = 0;
+        for (double x : samples) sum += x;
+        s.mean = sum / n;
+        double var = 0;
+        for (double x : samples) var += (x - s.mean) * (x - s.mean);
+        s.stddev = n > 1 ? std::sqrt(var / (n - 1)) : 0.0;
+        return s;
+    }
+};
+
+// Times `reps` calls of fn after `warmup` untimed ones
+inline Stats measure(int warmup, int reps, const std::function<void()>& fn) {
+    for (int i = 0; i < warmup; ++i) fn();
+    std::vector<double> samples;
+    for (int i = 0; i < reps; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double>(stop - start).count());
+    }
+    return Stats::from(samples);
+}
+
+struct Result {
+    std::string variant;
+    long long base_size;  // value from --sizes
+    long long size;       // actual size (size_for(base_size, threads) for weak scaling)
+    int threads;
+    Stats stats;
+    bool verified;
+    double speedup = 0;     // sequential median / this median, same size
+    double efficiency = 0;  // strong: speedup / threads, weak: T(1) / T(t) of this variant
+    bool has_efficiency = false; // not for sequential variants or without a baseline run
+};
+
+class Suite {
+public:
+    static const std::set<std::string>& common_options() {
+        static const std::set<std::string> keys = {
+            "config", "warmup", "reps", "threads", "sizes", "scaling", "json", "csv", "help"
+        };
+        return keys;
+    }
+
+    static void print_common_help() {
+        std::cout << "  --warmup=N        untimed runs before measuring (default 1)\n"
+                  << "  --reps=N          timed repetitions per configuration (default 5)\n"
+                  << "  --threads=LIST    thread counts to sweep, e.g. 1,2,4 (default powers of two up to max)\n"
+                  << "  --sizes=LIST      problem sizes to sweep\n"
+                  << "  --scaling=MODE    strong (fixed size) or weak (work x threads)\n"
+                  << "  --json=PATH       write results as JSON\n"
+                  << "  --csv=PATH        write results as CSV\n"
+                  << "  --config=PATH     read key=value options from a file\n";
+    }
+
+    // seq_variant names the baseline used for speedups; work_exponent is k
+    // when a kernel's work grows as size^k (for weak scaling)
+    Suite(const std::string& kernel, const Options& opt, const std::vector<long long>& default_sizes,
+          const std::string& size_unit, const std::string& seq_variant = "seq", double work_exponent = 1.0)
+        : kernel_(kernel), size_unit_(size_unit), seq_variant_(seq_variant), work_exponent_(work_exponent) {
+        warmup_ = (int)opt.get_int("warmup", 1);
+        reps_ = (int)opt.get_int("reps", 5);
+        sizes_ = opt.get_list("sizes", default_sizes);
+        json_ = opt.get_string("json", "");
+        csv_ = opt.get_string("csv", "");
+
+        std::string scaling = opt.get_string("scaling", "strong");
+        if (scaling != "strong" && scaling != "weak") opt.error("--scaling must be strong or weak");
+        weak_ = scaling == "weak";
+
+        std::vector<long long> def_threads;
+        const int max_threads = omp_get_max_threads();
+        for (int t = 1; t < max_threads; t *= 2) def_threads.push_back(t);
+        def_threads.push_back(max_threads);
+        for (long long t : opt.get_list("threads", def_threads)) {
+            if (t <= 0) opt.error("--threads values must be positive");
+            else threads_.push_back((int)t);
+        }
+
+        if (warmup_ < 0 || reps_ <= 0) opt.error("--warmup must be >= 0 and --reps > 0");
+        for (long long s : sizes_) {
+            if (s <= 0) opt.error("--sizes values must be positive");
+        }
+    }
+
+    int warmup() const { return warmup_; }
+    int reps() const { return reps_; }
+    const std::vector<int>& threads() const { return threads_; }
+    const std::vector<long long>& sizes() const { return sizes_; }
+    bool weak() const { return weak_; }
+
+    // Problem size for a base size at a thread count: weak scaling gives
+    // threads times the work of the base size
+    long long size_for(long long base, int threads) const {
+        if (!weak_) return base;
+        return std::max(1LL, std::llround(base * std::pow((double)threads, 1.0 / work_exponent_)));
+    }
+
+    Stats measure(const std::function<void()>& fn) const { return bench::measure(warmup_, reps_, fn); }
+
+    void add(const std::string& variant, long long base_size, long long size, int threads,
+             const Stats& stats, bool verified) {
+        results_.push_back({variant, base_size, size, threads, stats, verified});
+        const Result& r = results_.back();
+        std::cout << "  " << std::left << std::setw(10) << variant << std::right
+                  << " size " << std::setw(12) << size << "  threads " << std::setw(3) << threads
+                  << "  median " << std::fixed << std::setprecision(3) << std::setw(12) << r.stats.median * 1e6
+                  << " us  p95 " << std::setw(12) << r.stats.p95 * 1e6 << " us"
+                  << (verified ? "" : "  VERIFICATION FAILED") << "\n";
+    }
+
+    // Prints the scaling tables and writes JSON/CSV. Returns the exit code.
+    int finish() {
+        derive();
+
+        std::cout << "\n" << (weak_ ? "Weak" : "Strong") << " scaling (" << kernel_ << ", median of "
+                  << reps_ << " runs, " << warmup_ << " warmup)\n";
+        std::cout << std::left << std::setw(12) << "variant" << std::right << std::setw(14) << size_unit_
+                  << std::setw(9) << "threads" << std::setw(15) << "median(us)" << std::setw(15) << "p95(us)"
+                  << std::setw(13) << "stddev(us)" << std::setw(10) << "speedup" << std::setw(12) << "efficiency"
+                  << std::setw(10) << "verified" << "\n";
+        std::cout << std::string(110, '-') << "\n";
+        for (const Result& r : results_) {
+            std::cout << std::left << std::setw(12) << r.variant << std::right << std::setw(14) << r.size
+                      << std::setw(9) << r.threads << std::fixed << std::setprecision(3)
+                      << std::setw(15) << r.stats.median * 1e6 << std::setw(15) << r.stats.p95 * 1e6
+                      << std::setw(13) << r.stats.stddev * 1e6 << std::setprecision(2)
+                      << std::setw(9) << r.speedup << "x";
+            if (!r.has_efficiency) std::cout << std::setw(12) << "-";
+            else std::cout << std::setw(11) << r.efficiency * 100 << "%";
+            std::cout << std::setw(10) << (r.verified ? "yes" : "NO") << "\n";
+        }
+
+        bool ok = true;
+        if (!json_.empty()) ok = write_json(json_) && ok;
+        if (!csv_.empty()) ok = write_csv(csv_) && ok;
+        for (const Result& r : results_) ok = ok && r.verified;
+        return ok ? 0 : 1;
+    }
+
+private:
+    // "seq" and "seq_*" (e.g. seq_rcm) run on one thread by definition
+    bool is_sequential(const std::string& variant) const {
+        return variant == seq_variant_ || variant.rfind(seq_variant_ + "_", 0) == 0;
+    }
+
+    void derive() {
+        for (Result& r : results_) {
+            // Speedup over the sequential baseline of the same size
+            bool has_baseline = false;
+            for (const Result& s : results_) {
+                if (s.variant == seq_variant_ && s.size == r.size && r.stats.median > 0) {
+                    r.speedup = s.stats.median / r.stats.median;
+                    has_baseline = true;
+                }
+            }
+            if (is_sequential(r.variant)) continue;
+            if (!weak_) {
+                // T_seq / (T(t) * t) against the same baseline
+                if (has_baseline) {
+                    r.efficiency = r.speedup / r.threads;
+                    r.has_efficiency = true;
+                }
+                continue;
+            }
+            // Weak: the 1-thread run of this variant at the base size. The
+            // seq baseline at the scaled size would not do: its work can grow
+            // more slowly than the kernel's (Dijkstra: heap O(E log V)
+            // against the parallel O(V^2)).
+            for (const Result& b : results_) {
+                if (b.variant == r.variant && b.base_size == r.base_size && b.threads == 1 && r.stats.median > 0) {
+                    r.efficiency = b.stats.median / r.stats.median;
+                    r.has_efficiency = true;
+                }
+            }
+        }
+    }
+
+    bool write_json(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "Error: cannot write " << path << "\n";
+            return false;
+        }
+        out << std::setprecision(9);
+        out << "{\n  \"kernel\": \"" << kernel_ << "\",\n  \"scaling\": \"" << (weak_ ? "weak" : "strong")
+            << "\",\n  \"size_unit\": \"" << size_unit_ << "\",\n  \"warmup\": " << warmup_
+            << ",\n  \"reps\": " << reps_ << ",\n  \"results\": [\n";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const Result& r = results_[i];
+            out << "    {\"variant\": \"" << r.variant << "\", \"base_size\": " << r.base_size
+                << ", \"size\": " << r.size << ", \"threads\": " << r.threads
+                << ", \"min_s\": " << r.stats.min << ", \"median_s\": " << r.stats.median
+                << ", \"mean_s\": " << r.stats.mean << ", \"p95_s\": " << r.stats.p95
+                << ", \"stddev_s\": " << r.stats.stddev << ", \"speedup\": " << r.speedup
+                << ", \"efficiency\": ";
+            if (!r.has_efficiency) out << "null";
+            else out << r.efficiency;
+            out << ", \"verified\": " << (r.verified ? "true" : "false") << "}"
+                << (i + 1 < results_.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return (bool)out;
+    }
+
+    bool write_csv(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "Error: cannot write " << path << "\n";
+            return false;
+        }
+        out << std::setprecision(9);
+        out << "kernel,variant,scaling,base_size,size,threads,reps,min_s,median_s,mean_s,p95_s,stddev_s,speedup,efficiency,verified\n";
+        for (const Result& r : results_) {
+            out << kernel_ << "," << r.variant << "," << (weak_ ? "weak" : "strong") << ","
+                << r.base_size << "," << r.size << "," << r.threads << "," << r.stats.reps << ","
+                << r.stats.min << "," << r.stats.median << "," << r.stats.mean << "," << r.stats.p95 << ","
+                << r.stats.stddev << "," << r.speedup << ",";
+            if (r.has_efficiency) out << r.efficiency;
+            out << "," << (r.verified ? 1 : 0) << "\n";
+        }
+        return (bool)out;
+    }
+
+    std::string kernel_;
+    std::string size_unit_;
+    std::string seq_variant_;
+    double work_exponent_;
+    int warmup_ = 1;
+    int reps_ = 5;
+    bool weak_ = false;
+    std::vector<int> threads_;
+    std::vector<long long> sizes_;
+    std::string json_, csv_;
+    std::vector<Result> results_;
+};
+
+} // namespace bench
+
+#endif // BENCH_H
@@ -0,0 +1,63 @@
+#ifndef RANDOM_GRAPH_H
+#define RANDOM_GRAPH_H
+
+// Random input graphs for the graph kernels.
+//
+//   auto adj = bench::random_graph(vertices, 8, seed);              // vector<vector<int>>
+//   auto wadj = bench::random_graph(vertices, 8, 1, 100, seed);     // vector<vector<Edge>>
+//
+// Every vertex gets edge_density out-edges to uniformly random targets,
+// without self-loops, in the order they were drawn. Generation is
+// sequential, so the same seed always gives the same graph.
+
+#include <random>
+#include <vector>
+
+namespace bench {
+
+struct Edge {
+    int dest;
+    int weight;
+};
+
+namespace detail {
+
+// Calls add(u, dest) edge_density times per vertex u
+template <typename Add>
+void random_edges(int vertices, int edge_density, std::mt19937& gen, Add&& add) {
+    if (vertices < 2) return;
+    std::uniform_int_distribution<> dest_dist(0, vertices - 1);
+    for (int u = 0; u < vertices; ++u) {
+        for (int j = 0; j < edge_density; ++j) {
+            int dest = dest_dist(gen);
+            // Avoid self-loops
+            if (dest == u) dest = (dest < vertices - 1) ? dest + 1 : dest - 1;
+            add(u, dest);
+        }
+    }
+}
+
+} // namespace detail
+
+inline std::vector<std::vector<int>> random_graph(int vertices, int edge_density, unsigned seed) {
+    std::vector<std::vector<int>> adj(vertices);
+    std::mt19937 gen(seed);
+    detail::random_edges(vertices, edge_density, gen, [&](int u, int dest) { adj[u].push_back(dest); });
+    return adj;
+}
+
+// Weights are uniform in [min_weight, max_weight]
+inline std::vector<std::vector<Edge>> random_graph(int vertices, int edge_density, int min_weight, int max_weight,
+                                                   unsigned seed) {
+    std::vector<std::vector<Edge>> adj(vertices);
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> weight_dist(min_weight, max_weight);
+    detail::random_edges(vertices, edge_density, gen, [&](int u, int dest) {
+        adj[u].push_back({dest, weight_dist(gen)});
+    });
+    return adj;
+}
+
+} // namespace bench
+
+#endif
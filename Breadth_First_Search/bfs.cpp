@@ -1,11 +1,20 @@
 #include <iostream>
 #include <vector>
-#include <queue>
 #include <omp.h>
 #include <chrono>
 #include <random>
 #include <iomanip>
 #include <atomic>
+#include <sstream>
+#include <cmath>
+#include <memory>
+#include "../Tracing/trace.h"
+#include "../Perf_Counters/perf_counters.h"
+#include "../Benchmark/bench.h"
+#include "../Benchmark/random_graph.h"
+#include "../Graph_Reorder/reorder.h"
+#include "../Graph_Analytics/analytics.h"
+#include "bfs.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -24,149 +33,229 @@ public:
     void addEdge(int src, int dest) {
         adj[src].push_back(dest);
     }
+
+    // Traversal interface of the kernels in bfs.h
+    int num_vertices() const { return V; }
+
+    template <typename F>
+    void for_each_neighbor(int u, F&& f) const {
+        for (int v : adj[u]) f(v);
+    }
 };
 
-// Generate random graph
+// Generate random graph (Benchmark/random_graph.h), a different one on every run
 Graph generate_graph(int vertices, int edge_density) {
     Graph graph(vertices);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dest_dist(0, vertices - 1);
-    
-    // Each vertex will have approximately edge_density outgoing edges
-    #pragma omp parallel for
-    for (int i = 0; i < vertices; ++i) {
-        for (int j = 0; j < edge_density; ++j) {
-            int dest = dest_dist(gen);
-            
-            // Avoid self-loops
-            if (dest == i) {
-                if (dest < vertices - 1) dest++;
-                else dest--;
+    graph.adj = bench::random_graph(vertices, edge_density, random_device{}());
+    return graph;
+}
+
+// L1 distance between two rank vectors
+double l1_distance(const vector<double>& a, const vector<double>& b) {
+    if (a.size() != b.size()) return INFINITY;
+    double sum = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) sum += fabs(a[i] - b[i]);
+    return sum;
+}
+
+// Benchmark mode for --kernel=cc and --kernel=pagerank (Graph_Analytics)
+int run_analytics_benchmark(const bench::Options& opt, const string& kernel) {
+    bench::Suite suite(kernel, opt, {100000}, "vertices");
+    const int edge_density = (int)opt.get_int("density", 8);
+    const int segment = (int)opt.get_int("segment", analytics::SEGMENT_VERTICES);
+    const int max_iterations = (int)opt.get_int("iterations", 100);
+    double damping = 0.85, tolerance = 1e-6;
+    try {
+        damping = stod(opt.get_string("damping", "0.85"));
+        tolerance = stod(opt.get_string("tolerance", "1e-6"));
+    } catch (const exception&) {
+        opt.error("--damping and --tolerance must be numbers");
+    }
+    if (edge_density <= 0) opt.error("--density must be positive");
+    if (damping <= 0 || damping >= 1 || tolerance <= 0) opt.error("need 0 < --damping < 1 and --tolerance > 0");
+    if (segment <= 0 || max_iterations <= 0) opt.error("--segment and --iterations must be positive");
+    // Whole-graph kernels: no start vertex, and no relabeled variants
+    if (opt.has("start")) opt.error("--start applies to --kernel=bfs only");
+    if (opt.has("reorder")) opt.error("--reorder applies to --kernel=bfs only");
+    if (opt.report_errors()) return 1;
+
+    for (long long base : suite.sizes()) {
+        long long built = -1;
+        Graph graph(0);
+        vector<int> reference_labels;
+        analytics::PageRankResult reference_rank;
+        unique_ptr<analytics::PageRank> pull, blocked;
+        for (int threads : suite.threads()) {
+            const long long vertices = suite.size_for(base, threads);
+            if (vertices != built) {
+                graph = generate_graph((int)vertices, edge_density);
+                built = vertices;
+                if (kernel == "cc") {
+                    reference_labels = analytics::connected_components_seq(graph.adj);
+                    suite.add("seq", base, vertices, 1,
+                              suite.measure([&] { analytics::connected_components_seq(graph.adj); }), true);
+                    cout << "  weak components: " << analytics::count_components(reference_labels) << "\n";
+                } else {
+                    reference_rank = analytics::pagerank_seq(graph.adj, damping, tolerance, max_iterations);
+                    suite.add("seq", base, vertices, 1, suite.measure([&] {
+                        analytics::pagerank_seq(graph.adj, damping, tolerance, max_iterations);
+                    }), true);
+                    auto t0 = steady_clock::now();
+                    pull.reset(new analytics::PageRank(graph.adj, 0));
+                    auto t1 = steady_clock::now();
+                    blocked.reset(new analytics::PageRank(graph.adj, segment));
+                    auto t2 = steady_clock::now();
+                    cout << "  " << reference_rank.iterations << " iterations, L1 change " << scientific << setprecision(2)
+                         << reference_rank.error << fixed << "; transpose built in " << setprecision(1)
+                         << duration<double, milli>(t1 - t0).count() << " ms, " << blocked->num_segments()
+                         << " segments in " << duration<double, milli>(t2 - t1).count() << " ms\n";
+                }
             }
-            
-            #pragma omp critical
-            {
-                graph.addEdge(i, dest);
+
+            omp_set_num_threads(threads);
+            if (kernel == "cc") {
+                vector<int> labels;
+                bench::Stats stats = suite.measure([&] { labels = analytics::connected_components(graph.adj); });
+                suite.add("afforest", base, vertices, threads, stats, labels == reference_labels);
+            } else {
+                // Converged vectors agree to within the tolerance
+                analytics::PageRankResult r;
+                bench::Stats stats = suite.measure([&] { r = pull->run(damping, tolerance, max_iterations); });
+                suite.add("pull", base, vertices, threads, stats, l1_distance(r.rank, reference_rank.rank) < 2 * tolerance);
+                stats = suite.measure([&] { r = blocked->run(damping, tolerance, max_iterations); });
+                suite.add("blocked", base, vertices, threads, stats, l1_distance(r.rank, reference_rank.rank) < 2 * tolerance);
             }
         }
     }
-    
-    return graph;
+    return suite.finish();
 }
 
-// Sequential BFS traversal
-vector<int> bfs_seq(const Graph& graph, int start) {
-    vector<bool> visited(graph.V, false);
-    vector<int> traversal_order;
-    queue<int> q;
-    
-    // Mark the source vertex as visited and enqueue it
-    visited[start] = true;
-    q.push(start);
-    
-    while (!q.empty()) {
-        // Dequeue a vertex from queue
-        int u = q.front();
-        q.pop();
-        traversal_order.push_back(u);
-        
-        // Get all adjacent vertices of the dequeued vertex
-        // If an adjacent vertex has not been visited, mark it visited and enqueue it
-        for (int v : graph.adj[u]) {
-            if (!visited[v]) {
-                visited[v] = true;
-                q.push(v);
-            }
+// Non-interactive benchmark mode (see Benchmark/bench.h)
+int run_benchmark(const bench::Options& opt) {
+    auto known = bench::Suite::common_options();
+    known.insert({"kernel", "density", "start", "reorder", "damping", "tolerance", "iterations", "segment"});
+    opt.check_known(known);
+    if (opt.has("help")) {
+        cout << "Usage: bfs [options]   (no options: interactive)\n"
+             << "  --kernel=NAME     bfs, cc (connected components) or pagerank (default bfs)\n"
+             << "  --density=N       edges per vertex (default 8)\n"
+             << "  --start=V         start vertex (default 0)\n"
+             << "  --reorder=LIST    also run on the graph relabeled by rcm, degree and/or gorder\n"
+             << "  --damping=D       PageRank damping factor (default 0.85)\n"
+             << "  --tolerance=T     PageRank L1 convergence threshold (default 1e-6)\n"
+             << "  --iterations=N    PageRank iteration limit (default 100)\n"
+             << "  --segment=N       source vertices per PageRank segment (default " << analytics::SEGMENT_VERTICES << ")\n";
+        bench::Suite::print_common_help();
+        return 0;
+    }
+
+    const string kernel = opt.get_string("kernel", "bfs");
+    if (kernel == "cc" || kernel == "pagerank") return run_analytics_benchmark(opt, kernel);
+    if (kernel != "bfs") {
+        opt.error("--kernel must be bfs, cc or pagerank");
+        opt.report_errors();
+        return 1;
+    }
+
+    bench::Suite suite("bfs", opt, {100000}, "vertices");
+    const int edge_density = (int)opt.get_int("density", 8);
+    const int start_vertex = (int)opt.get_int("start", 0);
+    if (edge_density <= 0) opt.error("--density must be positive");
+    for (long long base : suite.sizes()) {
+        if (start_vertex < 0 || start_vertex >= base) opt.error("--start must be a vertex of every graph size");
+    }
+    vector<string> methods;
+    {
+        stringstream ss(opt.get_string("reorder", ""));
+        string method;
+        while (getline(ss, method, ',')) {
+            if (reorder::is_method(method)) methods.push_back(method);
+            else if (!method.empty()) opt.error("--reorder methods are rcm, degree and gorder");
         }
     }
-    
-    return traversal_order;
-}
+    if (opt.report_errors()) return 1;
 
-// Parallel BFS traversal
-vector<int> bfs_par(const Graph& graph, int start) {
-    vector<bool> visited(graph.V, false);
-    vector<int> traversal_order;
-    
-    // Mark the source vertex as visited
-    visited[start] = true;
-    
-    // Use a queue to keep track of frontier vertices
-    vector<int> current_frontier = {start};
-    
-    // Process frontier levels in parallel
-    while (!current_frontier.empty()) {
-        // Add current frontier to traversal order
-        traversal_order.insert(traversal_order.end(), current_frontier.begin(), current_frontier.end());
-        
-        // Create new frontier
-        vector<int> next_frontier;
-        
-        // Process current frontier in parallel to discover next frontier
-        #pragma omp parallel
-        {
-            // Local frontier to avoid contention
-            vector<int> local_frontier;
-            
-            // Process current frontier vertices in parallel
-            #pragma omp for nowait
-            for (int u : current_frontier) {
-                // Examine all neighbors of u
-                for (int v : graph.adj[u]) {
-                    bool already_visited = false;
-                    
-                    // Atomic check and update of visited status
-                    #pragma omp critical
-                    {
-                        if (!visited[v]) {
-                            visited[v] = true;
-                            already_visited = false;
-                        } else {
-                            already_visited = true;
-                        }
-                    }
-                    
-                    // If newly visited, add to local frontier
-                    if (!already_visited) {
-                        local_frontier.push_back(v);
+    for (long long base : suite.sizes()) {
+        long long built = -1;
+        Graph graph(0);
+        vector<int> reference;
+        vector<Graph> relabeled;
+        vector<reorder::Permutation> perms;
+        vector<char> envelope_ok; // rcm no worse than the sequential RCM
+        for (int threads : suite.threads()) {
+            const long long vertices = suite.size_for(base, threads);
+            if (vertices != built) {
+                graph = generate_graph((int)vertices, edge_density);
+                reference = bfs_seq(graph, start_vertex);
+                bench::Stats seq = suite.measure([&] { bfs_seq(graph, start_vertex); });
+                suite.add("seq", base, vertices, 1, seq, true);
+                built = vertices;
+
+                // Relabeled copies: one-off reordering cost, then the same BFS
+                long long edges = 0;
+                for (const auto& neighbors : graph.adj) edges += neighbors.size();
+                perf::Session counters;
+                if (!methods.empty()) {
+                    counters.start(1);
+                    bfs_seq(graph, start_vertex);
+                    perf::Sample before = counters.stop();
+                    cout << "  original: average edge gap " << fixed << setprecision(0) << reorder::average_gap(graph.adj) << "\n";
+                    perf::print(cout, before, "edge", edges, "    Counters");
+                }
+                relabeled.clear();
+                perms.clear();
+                envelope_ok.clear();
+                for (const string& method : methods) {
+                    auto t0 = steady_clock::now();
+                    perms.push_back(reorder::compute(method, graph.adj));
+                    relabeled.emplace_back((int)vertices);
+                    relabeled.back().adj = reorder::relabel(graph.adj, perms.back());
+                    double reorder_ms = duration<double, milli>(steady_clock::now() - t0).count();
+                    envelope_ok.push_back(true);
+                    if (method == "rcm") {
+                        reorder::RcmCheck check = reorder::check_rcm(graph.adj, perms.back());
+                        envelope_ok.back() = check.ok();
+                        cout << "  rcm: bandwidth " << check.par.bandwidth << " (sequential RCM " << check.seq.bandwidth
+                             << "), profile " << check.par.profile << " (sequential RCM " << check.seq.profile << ")\n";
                     }
+                    const reorder::Permutation& p = perms.back();
+                    const Graph& g = relabeled.back();
+
+                    vector<int> result;
+                    bench::Stats stats = suite.measure([&] { result = bfs_seq(g, p.new_id[start_vertex]); });
+                    p.to_original_ids(result);
+                    suite.add("seq_" + method, base, vertices, 1, stats, envelope_ok.back() && verify_results(reference, result, (int)vertices));
+
+                    counters.start(1);
+                    bfs_seq(g, p.new_id[start_vertex]);
+                    perf::Sample after = counters.stop();
+                    cout << "  " << method << ": reordered in " << fixed << setprecision(1) << reorder_ms
+                         << " ms, average edge gap " << setprecision(0) << reorder::average_gap(g.adj);
+                    double saved = seq.median - stats.median;
+                    if (saved > 0) cout << ", pays off after " << (long long)ceil(reorder_ms * 1e-3 / saved) << " traversals\n";
+                    else cout << ", no gain for seq\n";
+                    perf::print(cout, after, "edge", edges, "    Counters");
                 }
             }
-            
-            // Merge local frontier into global next frontier
-            #pragma omp critical
-            {
-                next_frontier.insert(next_frontier.end(), local_frontier.begin(), local_frontier.end());
+            omp_set_num_threads(threads);
+            vector<int> result;
+            bench::Stats stats = suite.measure([&] { result = bfs_par(graph, start_vertex); });
+            suite.add("par", base, vertices, threads, stats, verify_results(reference, result, (int)vertices));
+            for (size_t m = 0; m < methods.size(); ++m) {
+                const reorder::Permutation& p = perms[m];
+                stats = suite.measure([&] { result = bfs_par(relabeled[m], p.new_id[start_vertex]); });
+                p.to_original_ids(result);
+                suite.add("par_" + methods[m], base, vertices, threads, stats, envelope_ok[m] && verify_results(reference, result, (int)vertices));
             }
         }
-        
-        // Update current frontier for next iteration
-        current_frontier = next_frontier;
     }
-    
-    return traversal_order;
+    return suite.finish();
 }
 
-// Verify BFS results (Check if all nodes are visited in both traversals)
-bool verify_results(const vector<int>& seq_result, const vector<int>& par_result, int vertex_count) {
-    if (seq_result.size() != par_result.size()) return false;
-    
-    // Check if both traversals visit the same nodes (order may differ)
-    vector<bool> seq_visited(vertex_count, false);
-    vector<bool> par_visited(vertex_count, false);
-    
-    for (int v : seq_result) seq_visited[v] = true;
-    for (int v : par_result) par_visited[v] = true;
-    
-    for (int i = 0; i < vertex_count; ++i) {
-        if (seq_visited[i] != par_visited[i]) return false;
-    }
-    
-    return true;
-}
+int main(int argc, char* argv[]) {
+    bench::Options opt(argc, argv);
+    if (!opt.interactive()) return run_benchmark(opt);
 
-int main() {
     // User configuration
     int vertices;
     int edge_density;
@@ -212,24 +301,33 @@ int main() {
          << edge_density << " edges per vertex...\n";
     auto graph = generate_graph(vertices, edge_density);
     vector<int> seq_result, par_result;
+    long long edges = 0;
+    for (const auto& neighbors : graph.adj) edges += neighbors.size();
+    perf::Session counters;
 
     // Sequential BFS
     cout << "\nSequential BFS traversal...\n";
+    counters.start(1);
     auto start_seq = high_resolution_clock::now();
     seq_result = bfs_seq(graph, start_vertex);
     auto end_seq = high_resolution_clock::now();
+    auto seq_counters = counters.stop();
     auto seq_time = duration_cast<milliseconds>(end_seq - start_seq).count();
     cout << "Time: " << seq_time << " ms\n";
     cout << "Nodes visited: " << seq_result.size() << "\n";
+    perf::print(cout, seq_counters, "edge", edges);
 
     // Parallel BFS
     cout << "\nParallel BFS traversal (" << num_threads << " threads)...\n";
+    counters.start();
     auto start_par = high_resolution_clock::now();
     par_result = bfs_par(graph, start_vertex);
     auto end_par = high_resolution_clock::now();
+    auto par_counters = counters.stop();
     auto par_time = duration_cast<milliseconds>(end_par - start_par).count();
     cout << "Time: " << par_time << " ms\n";
     cout << "Nodes visited: " << par_result.size() << "\n";
+    perf::print(cout, par_counters, "edge", edges);
 
     // Verify results
     cout << "\nVerified: " << (verify_results(seq_result, par_result, vertices) ? "Yes" : "No") << "\n";
@@ -259,5 +357,9 @@ int main() {
     if (par_result.size() > display_count) cout << "... and " << par_result.size() - display_count << " more\n";
     else cout << "\n";
 
+#ifdef PARALLEL_TRACE
+    if (trace::write_chrome_json("bfs_trace.json")) cout << "\nTrace written to bfs_trace.json\n";
+#endif
+
     return 0;
 }
\ No newline at end of file
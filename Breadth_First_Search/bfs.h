@@ -0,0 +1,143 @@
+#ifndef BFS_H
+#define BFS_H
+
+// BFS kernels of the BFS program, written once for any graph type with
+//
+//   int num_vertices() const;
+//   void for_each_neighbor(int u, F f) const;     // f(v) for every edge u -> v
+//
+// i.e. the program's Graph and every layout of Graph_Compression/compressed_graph.h.
+// Both kernels return the traversal order; bfs_par lists each level in an
+// unspecified order, so compare results with verify_results.
+
+#include <queue>
+#include <vector>
+#include <omp.h>
+#include "../Tracing/trace.h"
+
+// Sequential BFS traversal
+template <typename G>
+std::vector<int> bfs_seq(const G& graph, int start) {
+    std::vector<bool> visited(graph.num_vertices(), false);
+    std::vector<int> traversal_order;
+    std::queue<int> q;
+
+    // Mark the source vertex as visited and enqueue it
+    visited[start] = true;
+    q.push(start);
+
+    while (!q.empty()) {
+        // Dequeue a vertex from queue
+        int u = q.front();
+        q.pop();
+        traversal_order.push_back(u);
+
+        // Get all adjacent vertices of the dequeued vertex
+        // If an adjacent vertex has not been visited, mark it visited and enqueue it
+        graph.for_each_neighbor(u, [&](int v) {
+            if (!visited[v]) {
+                visited[v] = true;
+                q.push(v);
+            }
+        });
+    }
+
+    return traversal_order;
+}
+
+// Parallel BFS traversal
+template <typename G>
+std::vector<int> bfs_par(const G& graph, int start) {
+    TRACE_ZONE("bfs_par");
+    std::vector<bool> visited(graph.num_vertices(), false);
+    std::vector<int> traversal_order;
+
+    // Mark the source vertex as visited
+    visited[start] = true;
+
+    // Use a queue to keep track of frontier vertices
+    std::vector<int> current_frontier = {start};
+
+    // Process frontier levels in parallel
+    while (!current_frontier.empty()) {
+        TRACE_ZONE("bfs_level");
+        TRACE_COUNTER("frontier_size", current_frontier.size());
+
+        // Add current frontier to traversal order
+        traversal_order.insert(traversal_order.end(), current_frontier.begin(), current_frontier.end());
+
+        // Create new frontier
+        std::vector<int> next_frontier;
+
+        // Process current frontier in parallel to discover next frontier
+        #pragma omp parallel
+        {
+            // Local frontier to avoid contention
+            std::vector<int> local_frontier;
+
+            // Closed before the merge, so waiting for the lock is not counted as expansion
+            {
+                TRACE_ZONE("frontier_expand");
+
+                // Process current frontier vertices in parallel
+                #pragma omp for nowait
+                for (int u : current_frontier) {
+                    // Examine all neighbors of u
+                    graph.for_each_neighbor(u, [&](int v) {
+                        bool already_visited = false;
+
+                        // Atomic check and update of visited status
+                        #pragma omp critical
+                        {
+                            if (!visited[v]) {
+                                visited[v] = true;
+                                already_visited = false;
+                            } else {
+                                already_visited = true;
+                            }
+                        }
+
+                        // If newly visited, add to local frontier
+                        if (!already_visited) {
+                            local_frontier.push_back(v);
+                        }
+                    });
+                }
+            }
+
+            // Merge local frontier into global next frontier
+            {
+                TRACE_ZONE("frontier_merge"); // includes waiting for the lock
+                #pragma omp critical
+                {
+                    next_frontier.insert(next_frontier.end(), local_frontier.begin(), local_frontier.end());
+                }
+            }
+        }
+
+        // Update current frontier for next iteration
+        current_frontier = next_frontier;
+    }
+
+    return traversal_order;
+}
+
+// Verify BFS results (Check if all nodes are visited in both traversals)
+inline bool verify_results(const std::vector<int>& seq_result, const std::vector<int>& par_result, int vertex_count) {
+    if (seq_result.size() != par_result.size()) return false;
+
+    // Check if both traversals visit the same nodes (order may differ)
+    std::vector<bool> seq_visited(vertex_count, false);
+    std::vector<bool> par_visited(vertex_count, false);
+
+    for (int v : seq_result) seq_visited[v] = true;
+    for (int v : par_result) par_visited[v] = true;
+
+    for (int i = 0; i < vertex_count; ++i) {
+        if (seq_visited[i] != par_visited[i]) return false;
+    }
+
+    return true;
+}
+
+#endif
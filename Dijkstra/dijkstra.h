@@ -0,0 +1,52 @@
+#ifndef DIJKSTRA_H
+#define DIJKSTRA_H
+
+// Sequential Dijkstra of the Dijkstra program, written once for any graph
+// type with
+//
+//   int num_vertices() const;
+//   void for_each_edge(int u, F f) const;         // f(v, weight) for every edge u -> v
+//
+// i.e. the program's Graph and every weighted layout of
+// Graph_Compression/compressed_graph.h. Unreachable vertices keep
+// numeric_limits<int>::max().
+
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Sequential Dijkstra's algorithm
+template <typename G>
+std::vector<int> dijkstra_seq(const G& graph, int src) {
+    const int INF = std::numeric_limits<int>::max();
+    std::vector<int> dist(graph.num_vertices(), INF);
+    dist[src] = 0;
+
+    // Priority queue: pair<distance, vertex>
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> pq;
+    pq.push({0, src});
+
+    while (!pq.empty()) {
+        int u = pq.top().second;
+        int d = pq.top().first;
+        pq.pop();
+
+        // If distance in queue is greater than known distance, skip
+        if (d > dist[u]) continue;
+
+        // Check all neighbors of u
+        graph.for_each_edge(u, [&](int v, int weight) {
+            // Relaxation step
+            if (dist[u] != INF && dist[u] + weight < dist[v]) {
+                dist[v] = dist[u] + weight;
+                pq.push({dist[v], v});
+            }
+        });
+    }
+
+    return dist;
+}
+
+#endif
@@ -1,20 +1,24 @@
 #include <iostream>
 #include <vector>
-#include <queue>
 #include <limits>
 #include <iomanip>
 #include <omp.h>
 #include <chrono>
 #include <random>
+#include <sstream>
+#include <cmath>
+#include "../Tracing/trace.h"
+#include "../Perf_Counters/perf_counters.h"
+#include "../Benchmark/bench.h"
+#include "../Benchmark/random_graph.h"
+#include "../Graph_Reorder/reorder.h"
+#include "dijkstra.h"
 
 using namespace std;
 using namespace std::chrono;
 
-// Structure to represent a graph edge
-struct Edge {
-    int dest;
-    int weight;
-};
+// Graph edge, shared with the generator (Benchmark/random_graph.h)
+using bench::Edge;
 
 // Structure to represent a graph
 class Graph {
@@ -31,77 +35,26 @@ public:
         Edge edge = {dest, weight};
         adj[src].push_back(edge);
     }
+
+    // Traversal interface of dijkstra_seq (dijkstra.h)
+    int num_vertices() const { return V; }
+
+    template <typename F>
+    void for_each_edge(int u, F&& f) const {
+        for (const Edge& edge : adj[u]) f(edge.dest, edge.weight);
+    }
 };
 
-// Generate random graph
+// Generate random graph (Benchmark/random_graph.h), a different one on every run
 Graph generate_graph(int vertices, int edge_density, int min_weight, int max_weight) {
     Graph graph(vertices);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dest_dist(0, vertices - 1);
-    uniform_int_distribution<> weight_dist(min_weight, max_weight);
-    
-    // Each vertex will have approximately edge_density outgoing edges
-    #pragma omp parallel for
-    for (int i = 0; i < vertices; ++i) {
-        int edges_to_create = edge_density;
-        
-        for (int j = 0; j < edges_to_create; ++j) {
-            int dest = dest_dist(gen);
-            
-            // Avoid self-loops
-            if (dest == i) {
-                if (dest < vertices - 1) dest++;
-                else dest--;
-            }
-            
-            int weight = weight_dist(gen);
-            
-            #pragma omp critical
-            {
-                graph.addEdge(i, dest, weight);
-            }
-        }
-    }
-    
+    graph.adj = bench::random_graph(vertices, edge_density, min_weight, max_weight, random_device{}());
     return graph;
 }
 
-// Sequential Dijkstra's algorithm
-vector<int> dijkstra_seq(const Graph& graph, int src) {
-    vector<int> dist(graph.V, numeric_limits<int>::max());
-    dist[src] = 0;
-    
-    // Priority queue: pair<distance, vertex>
-    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
-    pq.push({0, src});
-    
-    while (!pq.empty()) {
-        int u = pq.top().second;
-        int d = pq.top().first;
-        pq.pop();
-        
-        // If distance in queue is greater than known distance, skip
-        if (d > dist[u]) continue;
-        
-        // Check all neighbors of u
-        for (const Edge& edge : graph.adj[u]) {
-            int v = edge.dest;
-            int weight = edge.weight;
-            
-            // Relaxation step
-            if (dist[u] != numeric_limits<int>::max() && dist[u] + weight < dist[v]) {
-                dist[v] = dist[u] + weight;
-                pq.push({dist[v], v});
-            }
-        }
-    }
-    
-    return dist;
-}
-
 // Parallel Dijkstra's algorithm
 vector<int> dijkstra_par(const Graph& graph, int src) {
+    TRACE_ZONE("dijkstra_par");
     vector<int> dist(graph.V, numeric_limits<int>::max());
     dist[src] = 0;
     
@@ -110,6 +63,8 @@ vector<int> dijkstra_par(const Graph& graph, int src) {
     
     // Main loop for Dijkstra
     for (int count = 0; count < graph.V - 1; ++count) {
+        TRACE_ZONE("dijkstra_round");
+        
         // Find vertex with minimum distance
         int u = -1;
         int min_dist = numeric_limits<int>::max();
@@ -119,21 +74,28 @@ vector<int> dijkstra_par(const Graph& graph, int src) {
             int local_u = -1;
             int local_min = numeric_limits<int>::max();
             
-            // Each thread finds its local minimum
-            #pragma omp for nowait
-            for (int v = 0; v < graph.V; ++v) {
-                if (!processed[v] && dist[v] < local_min) {
-                    local_min = dist[v];
-                    local_u = v;
+            // Each thread finds its local minimum; the zone closes before
+            // the merge, so waiting for the lock is not counted as scanning
+            {
+                TRACE_ZONE("min_scan");
+                #pragma omp for nowait
+                for (int v = 0; v < graph.V; ++v) {
+                    if (!processed[v] && dist[v] < local_min) {
+                        local_min = dist[v];
+                        local_u = v;
+                    }
                 }
             }
             
             // Update global minimum
-            #pragma omp critical
             {
-                if (local_u != -1 && local_min < min_dist) {
-                    min_dist = local_min;
-                    u = local_u;
+                TRACE_ZONE("min_merge"); // includes waiting for the lock
+                #pragma omp critical
+                {
+                    if (local_u != -1 && local_min < min_dist) {
+                        min_dist = local_min;
+                        u = local_u;
+                    }
                 }
             }
         }
@@ -143,6 +105,7 @@ vector<int> dijkstra_par(const Graph& graph, int src) {
         processed[u] = true;
         
         // Parallel relaxation step
+        TRACE_ZONE("relax");
         #pragma omp parallel for
         for (int i = 0; i < graph.adj[u].size(); ++i) {
             int v = graph.adj[u][i].dest;
@@ -172,7 +135,124 @@ bool verify_results(const vector<int>& seq_result, const vector<int>& par_result
     return true;
 }
 
-int main() {
+// Non-interactive benchmark mode (see Benchmark/bench.h)
+int run_benchmark(const bench::Options& opt) {
+    auto known = bench::Suite::common_options();
+    known.insert({"density", "source", "min-weight", "max-weight", "reorder"});
+    opt.check_known(known);
+    if (opt.has("help")) {
+        cout << "Usage: dijkstra [options]   (no options: interactive)\n"
+             << "  --density=N       edges per vertex (default 8)\n"
+             << "  --source=V        source vertex (default 0)\n"
+             << "  --min-weight=W    smallest edge weight (default 1)\n"
+             << "  --max-weight=W    largest edge weight (default 100)\n"
+             << "  --reorder=LIST    also run on the graph relabeled by rcm, degree and/or gorder\n";
+        bench::Suite::print_common_help();
+        return 0;
+    }
+
+    // The parallel version scans all V vertices in each of its V rounds
+    bench::Suite suite("dijkstra", opt, {5000}, "vertices", "seq", 2.0);
+    const int edge_density = (int)opt.get_int("density", 8);
+    const int src_vertex = (int)opt.get_int("source", 0);
+    const int min_weight = (int)opt.get_int("min-weight", 1);
+    const int max_weight = (int)opt.get_int("max-weight", 100);
+    if (edge_density <= 0) opt.error("--density must be positive");
+    if (min_weight < 0 || max_weight < min_weight) opt.error("need 0 <= --min-weight <= --max-weight");
+    for (long long base : suite.sizes()) {
+        if (src_vertex < 0 || src_vertex >= base) opt.error("--source must be a vertex of every graph size");
+    }
+    vector<string> methods;
+    {
+        stringstream ss(opt.get_string("reorder", ""));
+        string method;
+        while (getline(ss, method, ',')) {
+            if (reorder::is_method(method)) methods.push_back(method);
+            else if (!method.empty()) opt.error("--reorder methods are rcm, degree and gorder");
+        }
+    }
+    if (opt.report_errors()) return 1;
+
+    auto target = [](auto& e) -> auto& { return e.dest; };
+    for (long long base : suite.sizes()) {
+        long long built = -1;
+        Graph graph(0);
+        vector<int> reference;
+        vector<Graph> relabeled;
+        vector<reorder::Permutation> perms;
+        vector<char> envelope_ok; // rcm no worse than the sequential RCM
+        for (int threads : suite.threads()) {
+            const long long vertices = suite.size_for(base, threads);
+            if (vertices != built) {
+                graph = generate_graph((int)vertices, edge_density, min_weight, max_weight);
+                reference = dijkstra_seq(graph, src_vertex);
+                bench::Stats seq = suite.measure([&] { dijkstra_seq(graph, src_vertex); });
+                suite.add("seq", base, vertices, 1, seq, true);
+                built = vertices;
+
+                // Relabeled copies: one-off reordering cost, then the same search
+                long long edges = 0;
+                for (const auto& edge_list : graph.adj) edges += edge_list.size();
+                perf::Session counters;
+                if (!methods.empty()) {
+                    counters.start(1);
+                    dijkstra_seq(graph, src_vertex);
+                    perf::Sample before = counters.stop();
+                    cout << "  original: average edge gap " << fixed << setprecision(0) << reorder::average_gap(graph.adj, target) << "\n";
+                    perf::print(cout, before, "edge", edges, "    Counters");
+                }
+                relabeled.clear();
+                perms.clear();
+                envelope_ok.clear();
+                for (const string& method : methods) {
+                    auto t0 = steady_clock::now();
+                    perms.push_back(reorder::compute(method, graph.adj, target));
+                    relabeled.emplace_back((int)vertices);
+                    relabeled.back().adj = reorder::relabel(graph.adj, perms.back(), target);
+                    double reorder_ms = duration<double, milli>(steady_clock::now() - t0).count();
+                    envelope_ok.push_back(true);
+                    if (method == "rcm") {
+                        reorder::RcmCheck check = reorder::check_rcm(graph.adj, perms.back(), target);
+                        envelope_ok.back() = check.ok();
+                        cout << "  rcm: bandwidth " << check.par.bandwidth << " (sequential RCM " << check.seq.bandwidth
+                             << "), profile " << check.par.profile << " (sequential RCM " << check.seq.profile << ")\n";
+                    }
+                    const reorder::Permutation& p = perms.back();
+                    const Graph& g = relabeled.back();
+
+                    vector<int> result;
+                    bench::Stats stats = suite.measure([&] { result = dijkstra_seq(g, p.new_id[src_vertex]); });
+                    suite.add("seq_" + method, base, vertices, 1, stats, envelope_ok.back() && verify_results(reference, p.to_original(result)));
+
+                    counters.start(1);
+                    dijkstra_seq(g, p.new_id[src_vertex]);
+                    perf::Sample after = counters.stop();
+                    cout << "  " << method << ": reordered in " << fixed << setprecision(1) << reorder_ms
+                         << " ms, average edge gap " << setprecision(0) << reorder::average_gap(g.adj, target);
+                    double saved = seq.median - stats.median;
+                    if (saved > 0) cout << ", pays off after " << (long long)ceil(reorder_ms * 1e-3 / saved) << " searches\n";
+                    else cout << ", no gain for seq\n";
+                    perf::print(cout, after, "edge", edges, "    Counters");
+                }
+            }
+            omp_set_num_threads(threads);
+            vector<int> result;
+            bench::Stats stats = suite.measure([&] { result = dijkstra_par(graph, src_vertex); });
+            suite.add("par", base, vertices, threads, stats, verify_results(reference, result));
+            for (size_t m = 0; m < methods.size(); ++m) {
+                const reorder::Permutation& p = perms[m];
+                stats = suite.measure([&] { result = dijkstra_par(relabeled[m], p.new_id[src_vertex]); });
+                suite.add("par_" + methods[m], base, vertices, threads, stats, envelope_ok[m] && verify_results(reference, p.to_original(result)));
+            }
+        }
+    }
+    return suite.finish();
+}
+
+int main(int argc, char* argv[]) {
+    bench::Options opt(argc, argv);
+    if (!opt.interactive()) return run_benchmark(opt);
+
     // User configuration
     int vertices;
     int edge_density;
@@ -220,22 +300,31 @@ int main() {
          << edge_density << " edges per vertex...\n";
     auto graph = generate_graph(vertices, edge_density, min_weight, max_weight);
     vector<int> seq_result, par_result;
+    long long edges = 0;
+    for (const auto& neighbors : graph.adj) edges += neighbors.size();
+    perf::Session counters;
 
     // Sequential Dijkstra
     cout << "\nSequential Dijkstra's algorithm...\n";
+    counters.start(1);
     auto start_seq = high_resolution_clock::now();
     seq_result = dijkstra_seq(graph, src_vertex);
     auto end_seq = high_resolution_clock::now();
+    auto seq_counters = counters.stop();
     auto seq_time = duration_cast<milliseconds>(end_seq - start_seq).count();
     cout << "Time: " << seq_time << " ms\n";
+    perf::print(cout, seq_counters, "edge", edges);
 
     // Parallel Dijkstra
     cout << "\nParallel Dijkstra's algorithm (" << num_threads << " threads)...\n";
+    counters.start();
     auto start_par = high_resolution_clock::now();
     par_result = dijkstra_par(graph, src_vertex);
     auto end_par = high_resolution_clock::now();
+    auto par_counters = counters.stop();
     auto par_time = duration_cast<milliseconds>(end_par - start_par).count();
     cout << "Time: " << par_time << " ms\n";
+    perf::print(cout, par_counters, "edge", edges);
 
     // Verify results
     cout << "\nVerified: " << (verify_results(seq_result, par_result) ? "Yes" : "No") << "\n";
@@ -264,5 +353,9 @@ int main() {
     }
     if (vertices > display_count) cout << "... and " << vertices - display_count << " more\n";
 
+#ifdef PARALLEL_TRACE
+    if (trace::write_chrome_json("dijkstra_trace.json")) cout << "\nTrace written to dijkstra_trace.json\n";
+#endif
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,411 @@
+#ifndef ANALYTICS_H
+#define ANALYTICS_H
+
+// Parallel connected components and PageRank on adjacency lists
+// (vector<vector<int>>, the BFS program's Graph::adj).
+//
+//   vector<int> comp = analytics::connected_components(graph.adj);
+//   analytics::PageRank pr(graph.adj);            // builds the blocked transpose once
+//   analytics::PageRankResult r = pr.run();       // damping 0.85, L1 tolerance 1e-6
+//
+// Connected components follow Afforest. Every vertex starts as its own
+// tree in a lock-free union-find. The first few neighbours of every vertex
+// are linked, then about 1000 random vertices are sampled to find the
+// largest component. Vertices already in it skip their remaining edges,
+// which usually covers most of the graph. Links always point the larger
+// root at the smaller one, so each component is labeled by its smallest
+// vertex. Edges are treated as undirected (weak components). With
+// symmetric = false, vertices of the largest component still scan their
+// edges, because an edge into a smaller component is not seen from the
+// other side.
+//
+// PageRank pulls: each vertex sums rank / out-degree over its in-edges. The
+// in-edges are split into segments by source vertex, so that the
+// contributions one segment reads (8 bytes per vertex) stay in cache while
+// every destination is gathered. Dangling vertices spread their rank
+// evenly. Iteration stops when the L1 change of the rank vector drops
+// below the tolerance.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <omp.h>
+
+namespace analytics {
+
+// Neighbours per vertex linked before sampling
+const int NEIGHBOR_ROUNDS = 2;
+
+// Vertices sampled to find the largest component
+const int SAMPLES = 1024;
+
+// Source vertices per PageRank segment: 8 bytes each, 256 KiB in total
+const int SEGMENT_VERTICES = 32768;
+
+// Destinations per block (2^16) when the transpose is bucketed
+const int BLOCK_BITS = 16;
+
+namespace detail {
+
+// Joins the trees of u and v, pointing the larger root at the smaller
+inline void link(int u, int v, std::vector<std::atomic<int>>& comp) {
+    int p1 = comp[u].load(std::memory_order_relaxed);
+    int p2 = comp[v].load(std::memory_order_relaxed);
+    while (p1 != p2) {
+        const int high = std::max(p1, p2), low = std::min(p1, p2);
+        int p_high = comp[high].load(std::memory_order_relaxed);
+        if (p_high == low) break; // already linked by another thread
+        if (p_high == high && comp[high].compare_exchange_strong(p_high, low, std::memory_order_relaxed)) break;
+        // high was not a root any more: retry one level further up
+        p1 = comp[comp[high].load(std::memory_order_relaxed)].load(std::memory_order_relaxed);
+        p2 = comp[low].load(std::memory_order_relaxed);
+    }
+}
+
+// Points every vertex directly at its root
+inline void compress(std::vector<std::atomic<int>>& comp) {
+    const int n = (int)comp.size();
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int v = 0; v < n; ++v) {
+        int p = comp[v].load(std::memory_order_relaxed);
+        while (p != comp[p].load(std::memory_order_relaxed)) {
+            p = comp[p].load(std::memory_order_relaxed);
+            comp[v].store(p, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Most frequent label among SAMPLES random vertices
+inline int largest_component(const std::vector<std::atomic<int>>& comp) {
+    std::mt19937 gen(27491095);
+    std::uniform_int_distribution<int> dist(0, (int)comp.size() - 1);
+    std::unordered_map<int, int> count;
+    for (int i = 0; i < SAMPLES; ++i) count[comp[dist(gen)].load(std::memory_order_relaxed)]++;
+    auto best = std::max_element(count.begin(), count.end(),
+                                 [](const auto& a, const auto& b) { return a.second < b.second; });
+    return best->first;
+}
+
+} // namespace detail
+
+// Component label of every vertex: the smallest vertex id in its component
+inline std::vector<int> connected_components(const std::vector<std::vector<int>>& adj, bool symmetric = false) {
+    const int n = (int)adj.size();
+    std::vector<std::atomic<int>> comp(n);
+    #pragma omp parallel for
+    for (int v = 0; v < n; ++v) comp[v].store(v, std::memory_order_relaxed);
+    if (n == 0) return {};
+
+    // Link the first neighbours of every vertex, one round at a time
+    for (int r = 0; r < NEIGHBOR_ROUNDS; ++r) {
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int u = 0; u < n; ++u) {
+            if (r < (int)adj[u].size()) detail::link(u, adj[u][r], comp);
+        }
+        detail::compress(comp);
+    }
+
+    // Finish the remaining edges, skipping most of the largest component
+    const int c = detail::largest_component(comp);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int u = 0; u < n; ++u) {
+        const bool in_largest = comp[u].load(std::memory_order_relaxed) == c;
+        if (in_largest && symmetric) continue;
+        for (size_t i = NEIGHBOR_ROUNDS; i < adj[u].size(); ++i) {
+            const int v = adj[u][i];
+            if (in_largest && comp[v].load(std::memory_order_relaxed) == c) continue;
+            detail::link(u, v, comp);
+        }
+    }
+    detail::compress(comp);
+
+    std::vector<int> labels(n);
+    #pragma omp parallel for
+    for (int v = 0; v < n; ++v) labels[v] = comp[v].load(std::memory_order_relaxed);
+    return labels;
+}
+
+// Sequential reference: union-find with path halving, same labels
+inline std::vector<int> connected_components_seq(const std::vector<std::vector<int>>& adj) {
+    const int n = (int)adj.size();
+    std::vector<int> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int v) {
+        while (parent[v] != v) {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    };
+    for (int u = 0; u < n; ++u) {
+        for (int v : adj[u]) {
+            int a = find(u), b = find(v);
+            if (a != b) parent[std::max(a, b)] = std::min(a, b);
+        }
+    }
+    std::vector<int> labels(n);
+    for (int v = 0; v < n; ++v) labels[v] = find(v);
+    return labels;
+}
+
+inline int count_components(const std::vector<int>& labels) {
+    int count = 0;
+    #pragma omp parallel for reduction(+ : count)
+    for (int v = 0; v < (int)labels.size(); ++v) count += labels[v] == v;
+    return count;
+}
+
+struct PageRankResult {
+    std::vector<double> rank;
+    int iterations = 0;
+    double error = 0.0; // L1 change in the last iteration
+};
+
+// Pull-based PageRank over a segmented transpose, built once per graph
+class PageRank {
+public:
+    // segment_vertices <= 0 puts all sources in one segment (plain pull)
+    explicit PageRank(const std::vector<std::vector<int>>& adj, int segment_vertices = SEGMENT_VERTICES)
+        : n_((int)adj.size()), out_degree_(n_) {
+        if (segment_vertices <= 0 || segment_vertices > n_) segment_vertices = std::max(n_, 1);
+        segment_vertices_ = segment_vertices;
+
+        #pragma omp parallel for
+        for (int u = 0; u < n_; ++u) out_degree_[u] = (int)adj[u].size();
+
+        // Transpose without atomics, in two stable steps, so every in-list
+        // comes out sorted by source. First the edges are bucketed by block
+        // of destinations: thread t scans a contiguous range of sources and
+        // writes at its own offsets within each bucket. Then each block is
+        // counting-sorted by destination, independently of the others.
+        const int num_blocks = n_ > 0 ? ((n_ - 1) >> BLOCK_BITS) + 1 : 0;
+        const int max_threads = omp_get_max_threads();
+        std::vector<int64_t> bucket_pos((size_t)max_threads * num_blocks, 0);
+        std::vector<int64_t> block_start(num_blocks + 1, 0);
+        std::vector<int64_t> in_offsets(n_ + 1, 0);
+        std::vector<int> bucket_dest, bucket_src, in_src;
+        #pragma omp parallel
+        {
+            const int t = omp_get_thread_num();
+            const int nt = omp_get_num_threads();
+            const int begin = (int)((int64_t)n_ * t / nt), end = (int)((int64_t)n_ * (t + 1) / nt);
+            int64_t* my_pos = &bucket_pos[(size_t)t * num_blocks];
+
+            for (int u = begin; u < end; ++u) {
+                for (int v : adj[u]) my_pos[v >> BLOCK_BITS]++;
+            }
+            #pragma omp barrier
+            #pragma omp single
+            {
+                int64_t sum = 0;
+                for (int b = 0; b < num_blocks; ++b) {
+                    block_start[b] = sum;
+                    for (int r = 0; r < nt; ++r) {
+                        const int64_t c = bucket_pos[(size_t)r * num_blocks + b];
+                        bucket_pos[(size_t)r * num_blocks + b] = sum;
+                        sum += c;
+                    }
+                }
+                block_start[num_blocks] = sum;
+                bucket_dest.resize(sum);
+                bucket_src.resize(sum);
+                in_src.resize(sum);
+            }
+            for (int u = begin; u < end; ++u) {
+                for (int v : adj[u]) {
+                    const int64_t i = my_pos[v >> BLOCK_BITS]++;
+                    bucket_dest[i] = v;
+                    bucket_src[i] = u;
+                }
+            }
+            #pragma omp barrier
+
+            // In-degrees; every block owns its own range of in_offsets
+            #pragma omp for schedule(dynamic, 1)
+            for (int b = 0; b < num_blocks; ++b) {
+                for (int64_t i = block_start[b]; i < block_start[b + 1]; ++i) in_offsets[bucket_dest[i] + 1]++;
+            }
+            #pragma omp single
+            for (int v = 0; v < n_; ++v) in_offsets[v + 1] += in_offsets[v];
+
+            #pragma omp for schedule(dynamic, 1)
+            for (int b = 0; b < num_blocks; ++b) {
+                const int lo = b << BLOCK_BITS, hi = std::min(n_, lo + (1 << BLOCK_BITS));
+                std::vector<int64_t> cursor(in_offsets.begin() + lo, in_offsets.begin() + hi);
+                for (int64_t i = block_start[b]; i < block_start[b + 1]; ++i) {
+                    in_src[cursor[bucket_dest[i] - lo]++] = bucket_src[i];
+                }
+            }
+        }
+        std::vector<int>().swap(bucket_dest);
+        std::vector<int>().swap(bucket_src);
+
+        // Cut every in-list into runs of one segment each, in one pass.
+        // Thread t takes a contiguous range of destinations, counts its
+        // runs and edges per segment, and after a prefix sum over
+        // (segment, thread) writes them at its own offsets, so each
+        // segment lists its destinations in ascending order.
+        const int num_segments = (n_ + segment_vertices - 1) / segment_vertices;
+        segments_.resize(num_segments);
+        std::vector<int64_t> dest_pos((size_t)max_threads * num_segments, 0);
+        std::vector<int64_t> edge_pos((size_t)max_threads * num_segments, 0);
+        #pragma omp parallel
+        {
+            const int t = omp_get_thread_num();
+            const int nt = omp_get_num_threads();
+            const int begin = (int)((int64_t)n_ * t / nt), end = (int)((int64_t)n_ * (t + 1) / nt);
+            int64_t* my_dests = &dest_pos[(size_t)t * num_segments];
+            int64_t* my_edges = &edge_pos[(size_t)t * num_segments];
+
+            // Calls f(segment, first, last) for each run of v's sorted in-list
+            auto for_each_run = [&](int v, auto&& f) {
+                int64_t e = in_offsets[v];
+                while (e < in_offsets[v + 1]) {
+                    const int s = in_src[e] / segment_vertices;
+                    const int64_t first = e;
+                    while (e < in_offsets[v + 1] && in_src[e] / segment_vertices == s) ++e;
+                    f(s, first, e);
+                }
+            };
+
+            for (int v = begin; v < end; ++v) {
+                for_each_run(v, [&](int s, int64_t first, int64_t last) {
+                    my_dests[s]++;
+                    my_edges[s] += last - first;
+                });
+            }
+            #pragma omp barrier
+
+            #pragma omp for
+            for (int s = 0; s < num_segments; ++s) {
+                int64_t dests = 0, edges = 0;
+                for (int r = 0; r < nt; ++r) {
+                    const int64_t d = dest_pos[(size_t)r * num_segments + s];
+                    const int64_t c = edge_pos[(size_t)r * num_segments + s];
+                    dest_pos[(size_t)r * num_segments + s] = dests;
+                    edge_pos[(size_t)r * num_segments + s] = edges;
+                    dests += d;
+                    edges += c;
+                }
+                Segment& seg = segments_[s];
+                seg.dest.resize(dests);
+                seg.offsets.resize(dests + 1);
+                seg.offsets[dests] = edges;
+                seg.src.resize(edges);
+            }
+            // implicit barrier
+
+            for (int v = begin; v < end; ++v) {
+                for_each_run(v, [&](int s, int64_t first, int64_t last) {
+                    Segment& seg = segments_[s];
+                    const int64_t i = my_dests[s]++;
+                    seg.dest[i] = v;
+                    seg.offsets[i] = my_edges[s];
+                    std::copy(in_src.begin() + first, in_src.begin() + last, seg.src.begin() + my_edges[s]);
+                    my_edges[s] += last - first;
+                });
+            }
+        }
+    }
+
+    int num_segments() const { return (int)segments_.size(); }
+    int segment_vertices() const { return segment_vertices_; }
+
+    PageRankResult run(double damping = 0.85, double tolerance = 1e-6, int max_iterations = 100) const {
+        PageRankResult result;
+        if (n_ == 0) return result;
+        std::vector<double> rank(n_, 1.0 / n_), next(n_), contrib(n_);
+
+        for (int it = 0; it < max_iterations; ++it) {
+            double dangling = 0.0;
+            #pragma omp parallel for reduction(+ : dangling)
+            for (int u = 0; u < n_; ++u) {
+                if (out_degree_[u] > 0) contrib[u] = rank[u] / out_degree_[u];
+                else {
+                    contrib[u] = 0.0;
+                    dangling += rank[u];
+                }
+                next[u] = 0.0;
+            }
+
+            // One segment at a time; a destination occurs once per segment
+            for (const Segment& seg : segments_) {
+                #pragma omp parallel for schedule(dynamic, 256)
+                for (size_t i = 0; i < seg.dest.size(); ++i) {
+                    double sum = 0.0;
+                    for (int64_t e = seg.offsets[i]; e < seg.offsets[i + 1]; ++e) sum += contrib[seg.src[e]];
+                    next[seg.dest[i]] += sum;
+                }
+            }
+
+            const double base = (1.0 - damping) / n_ + damping * dangling / n_;
+            double error = 0.0;
+            #pragma omp parallel for reduction(+ : error)
+            for (int v = 0; v < n_; ++v) {
+                next[v] = base + damping * next[v];
+                error += std::fabs(next[v] - rank[v]);
+            }
+            rank.swap(next);
+            result.iterations = it + 1;
+            result.error = error;
+            if (error < tolerance) break;
+        }
+        result.rank = std::move(rank);
+        return result;
+    }
+
+private:
+    // In-edges from one range of source vertices
+    struct Segment {
+        std::vector<int> dest;        // destinations with at least one such edge
+        std::vector<int64_t> offsets; // into src, per destination
+        std::vector<int> src;
+    };
+
+    int n_;
+    int segment_vertices_;
+    std::vector<int> out_degree_;
+    std::vector<Segment> segments_;
+};
+
+// Sequential reference: push-based power iteration with the same update
+inline PageRankResult pagerank_seq(const std::vector<std::vector<int>>& adj, double damping = 0.85,
+                                   double tolerance = 1e-6, int max_iterations = 100) {
+    const int n = (int)adj.size();
+    PageRankResult result;
+    if (n == 0) return result;
+    std::vector<double> rank(n, 1.0 / n), next(n);
+    for (int it = 0; it < max_iterations; ++it) {
+        std::fill(next.begin(), next.end(), 0.0);
+        double dangling = 0.0;
+        for (int u = 0; u < n; ++u) {
+            if (adj[u].empty()) {
+                dangling += rank[u];
+                continue;
+            }
+            const double share = rank[u] / adj[u].size();
+            for (int v : adj[u]) next[v] += share;
+        }
+        const double base = (1.0 - damping) / n + damping * dangling / n;
+        double error = 0.0;
+        for (int v = 0; v < n; ++v) {
+            next[v] = base + damping * next[v];
+            error += std::fabs(next[v] - rank[v]);
+        }
+        rank.swap(next);
+        result.iterations = it + 1;
+        result.error = error;
+        if (error < tolerance) break;
+    }
+    result.rank = std::move(rank);
+    return result;
+}
+
+} // namespace analytics
+
+#endif // ANALYTICS_H
@@ -0,0 +1,180 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <omp.h>
+#include "compressed_graph.h"
+#include "../Benchmark/bench.h"
+#include "../Benchmark/random_graph.h"
+#include "../Graph_Reorder/reorder.h"
+#include "../Breadth_First_Search/bfs.h"
+#include "../Dijkstra/dijkstra.h"
+
+using namespace std;
+using namespace std::chrono;
+
+using bench::Edge;
+
+// vector<vector<int>> / vector<vector<Edge>> behind the cgraph interface,
+// i.e. the layout the BFS and Dijkstra programs use
+template <typename E>
+class ListGraph {
+public:
+    explicit ListGraph(const vector<vector<E>>& adj) : adj_(adj) {}
+
+    int num_vertices() const { return (int)adj_.size(); }
+
+    // Vector headers, capacity and an estimated 16 bytes of allocator
+    // overhead per non-empty list
+    size_t bytes() const {
+        size_t total = sizeof(adj_) + adj_.capacity() * sizeof(vector<E>);
+        for (const auto& list : adj_) total += list.capacity() * sizeof(E) + (list.capacity() ? 16 : 0);
+        return total;
+    }
+
+    template <typename F>
+    void for_each_neighbor(int u, F&& f) const {
+        for (const E& e : adj_[u]) f(target(e));
+    }
+
+    template <typename F>
+    void for_each_edge(int u, F&& f) const {
+        for (const E& e : adj_[u]) f(e.dest, e.weight);
+    }
+
+private:
+    static int target(int v) { return v; }
+    static int target(const Edge& e) { return e.dest; }
+
+    const vector<vector<E>>& adj_;
+};
+
+// Size against both uncompressed layouts: list_bytes includes an assumed
+// allocator overhead per list, csr_bytes is exact
+void print_layout(const string& name, size_t bytes, size_t list_bytes, size_t csr_bytes, long long edges) {
+    cout << "  " << left << setw(8) << name << right << setw(10) << fixed << setprecision(1) << bytes / 1048576.0
+         << " MiB" << setw(9) << setprecision(2) << (double)bytes / edges << " B/edge"
+         << setw(8) << (double)list_bytes / bytes << "x vs list" << setw(8) << (double)csr_bytes / bytes << "x vs csr\n";
+}
+
+int main(int argc, char* argv[]) {
+    bench::Options opt(argc, argv);
+    auto known = bench::Suite::common_options();
+    known.insert({"kernel", "density", "start", "min-weight", "max-weight", "seed", "reorder"});
+    opt.check_known(known);
+    if (opt.has("help")) {
+        cout << "Usage: compressed_graph [options]\n"
+             << "  --kernel=NAME     bfs (parallel, swept over threads) or sssp (sequential Dijkstra)\n"
+             << "  --density=N       edges per vertex (default 8)\n"
+             << "  --start=V         start vertex (default 0)\n"
+             << "  --min-weight=W    smallest edge weight (default 1)\n"
+             << "  --max-weight=W    largest edge weight (default 100)\n"
+             << "  --seed=S          random graph seed (default 1)\n"
+             << "  --reorder=METHOD  relabel with rcm, degree or gorder before encoding\n";
+        bench::Suite::print_common_help();
+        return 0;
+    }
+
+    const string kernel = opt.get_string("kernel", "bfs");
+    bench::Suite suite("compressed_" + kernel, opt, {1000000}, "vertices");
+    const int edge_density = (int)opt.get_int("density", 8);
+    const int start_vertex = (int)opt.get_int("start", 0);
+    const int min_weight = (int)opt.get_int("min-weight", 1);
+    const int max_weight = (int)opt.get_int("max-weight", 100);
+    const unsigned seed = (unsigned)opt.get_int("seed", 1);
+    const string method = opt.get_string("reorder", "");
+    if (kernel != "bfs" && kernel != "sssp") opt.error("--kernel must be bfs or sssp");
+    if (edge_density <= 0) opt.error("--density must be positive");
+    if (min_weight < 0 || max_weight < min_weight) opt.error("need 0 <= --min-weight <= --max-weight");
+    if (!method.empty() && !reorder::is_method(method)) opt.error("--reorder must be rcm, degree or gorder");
+    for (long long base : suite.sizes()) {
+        if (start_vertex < 0 || start_vertex >= base) opt.error("--start must be a vertex of every graph size");
+    }
+    if (opt.report_errors()) return 1;
+
+    cout << "Stream VByte decoder: " << cgraph::simd_name() << "\n";
+    for (long long base : suite.sizes()) {
+        long long built = -1;
+        vector<vector<int>> plain;       // bfs
+        vector<vector<Edge>> weighted;   // sssp
+        cgraph::CSR csr;
+        unique_ptr<cgraph::VarintGraph> varint;
+        unique_ptr<cgraph::StreamVByteGraph> svb;
+        vector<int> reference;
+        int start = start_vertex;
+        for (int threads : suite.threads()) {
+            const long long vertices = suite.size_for(base, threads);
+            if (vertices != built) {
+                weighted = bench::random_graph((int)vertices, edge_density, min_weight, max_weight, seed);
+                start = start_vertex;
+                if (!method.empty()) {
+                    auto target = [](auto& e) -> auto& { return e.dest; };
+                    reorder::Permutation p = reorder::compute(method, weighted, target);
+                    weighted = reorder::relabel(weighted, p, target);
+                    start = p.new_id[start_vertex];
+                }
+                if (kernel == "bfs") {
+                    plain.assign(vertices, {});
+                    for (long long u = 0; u < vertices; ++u) {
+                        for (const Edge& e : weighted[u]) plain[u].push_back(e.dest);
+                    }
+                    vector<vector<Edge>>().swap(weighted);
+                    csr = cgraph::CSR::from_lists(plain);
+                } else {
+                    csr = cgraph::CSR::from_lists(weighted, [](const Edge& e) { return e.dest; },
+                                                  [](const Edge& e) { return e.weight; });
+                }
+                varint.reset(new cgraph::VarintGraph(csr));
+                svb.reset(new cgraph::StreamVByteGraph(csr));
+                built = vertices;
+
+                const long long edges = csr.num_edges();
+                const size_t list_bytes = kernel == "bfs" ? ListGraph<int>(plain).bytes() : ListGraph<Edge>(weighted).bytes();
+                cout << "Graph: " << vertices << " vertices, " << edges << " edges"
+                     << (method.empty() ? "" : ", reordered by " + method) << "\n";
+                print_layout("list", list_bytes, list_bytes, csr.bytes(), edges);
+                print_layout("csr", csr.bytes(), list_bytes, csr.bytes(), edges);
+                print_layout("varint", varint->bytes(), list_bytes, csr.bytes(), edges);
+                print_layout("svb", svb->bytes(), list_bytes, csr.bytes(), edges);
+
+                // Sequential runs: the BFS baseline, or every SSSP layout
+                vector<int> result;
+                bench::Stats stats;
+                if (kernel == "bfs") {
+                    ListGraph<int> list(plain);
+                    reference = bfs_seq(list, start);
+                    suite.add("seq", base, vertices, 1, suite.measure([&] { bfs_seq(list, start); }), true);
+                } else {
+                    ListGraph<Edge> list(weighted);
+                    reference = dijkstra_seq(list, start);
+                    suite.add("seq", base, vertices, 1, suite.measure([&] { dijkstra_seq(list, start); }), true);
+                    stats = suite.measure([&] { result = dijkstra_seq(csr, start); });
+                    suite.add("seq_csr", base, vertices, 1, stats, result == reference);
+                    stats = suite.measure([&] { result = dijkstra_seq(*varint, start); });
+                    suite.add("seq_varint", base, vertices, 1, stats, result == reference);
+                    stats = suite.measure([&] { result = dijkstra_seq(*svb, start); });
+                    suite.add("seq_svb", base, vertices, 1, stats, result == reference);
+                }
+            }
+            if (kernel != "bfs") continue;
+
+            omp_set_num_threads(threads);
+            // The BFS program's kernel; levels come out in any order, so
+            // compare the visited sets
+            ListGraph<int> list(plain);
+            vector<int> result;
+            bench::Stats stats = suite.measure([&] { result = bfs_par(list, start); });
+            suite.add("list", base, vertices, threads, stats, verify_results(reference, result, (int)vertices));
+            stats = suite.measure([&] { result = bfs_par(csr, start); });
+            suite.add("csr", base, vertices, threads, stats, verify_results(reference, result, (int)vertices));
+            stats = suite.measure([&] { result = bfs_par(*varint, start); });
+            suite.add("varint", base, vertices, threads, stats, verify_results(reference, result, (int)vertices));
+            stats = suite.measure([&] { result = bfs_par(*svb, start); });
+            suite.add("svb", base, vertices, threads, stats, verify_results(reference, result, (int)vertices));
+        }
+    }
+    return suite.finish();
+}
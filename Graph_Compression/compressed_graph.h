@@ -0,0 +1,411 @@
+#ifndef COMPRESSED_GRAPH_H
+#define COMPRESSED_GRAPH_H
+
+// Compressed adjacency storage with on-the-fly decoding.
+//
+//   cgraph::CSR csr = cgraph::CSR::from_lists(graph.adj);     // sorted lists
+//   cgraph::VarintGraph small(csr);
+//   cgraph::StreamVByteGraph fast(csr);
+//   fast.for_each_neighbor(u, [&](int v) { ... });
+//   fast.for_each_edge(u, [&](int v, int w) { ... });         // weighted graphs
+//
+// for_each_edge requires weighted(): a graph built without weights stores
+// none, and for_each_edge throws std::logic_error instead of decoding
+// weights that were never written.
+//
+// Neighbour lists are sorted, so each list is stored as gaps between
+// consecutive targets; the first target is stored as is. Small gaps need
+// few bytes:
+//
+// - VarintGraph: LEB128 varints, 7 bits per byte. Edge weights (if any)
+//   follow their target as another varint. Smallest, decoded byte by byte.
+// - StreamVByteGraph: Stream VByte. Values are grouped in fours. One
+//   control byte holds the 1-4 byte length of each value and the data bytes
+//   follow separately, so a group decodes with one SSSE3 shuffle plus a
+//   prefix sum for the gaps. A scalar decoder is used without SSSE3.
+//   Weights are a second stream of the same kind, without gaps.
+//
+// Every type has the same interface as CSR, so traversal code is written
+// once as a template. All encoding runs in parallel: sizes first, then a
+// prefix sum, then each vertex writes its own range.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <omp.h>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace cgraph {
+
+// Name of the instruction set used by the Stream VByte decoder
+inline const char* simd_name() {
+#if defined(__SSSE3__)
+    return "SSSE3";
+#else
+    return "scalar";
+#endif
+}
+
+namespace detail {
+
+inline void require_weights(bool weighted) {
+    if (!weighted) throw std::logic_error("for_each_edge on a graph built without weights");
+}
+
+} // namespace detail
+
+// Plain compressed sparse row layout: the uncompressed reference
+class CSR {
+public:
+    // Edge lists of plain target ids
+    static CSR from_lists(const std::vector<std::vector<int>>& adj) {
+        return build(adj, [](int e) { return e; }, (NoWeight*)nullptr);
+    }
+
+    // Edge lists of structs; target(e) and weight(e) read an edge
+    template <typename E, typename Target, typename Weight>
+    static CSR from_lists(const std::vector<std::vector<E>>& adj, Target target, Weight weight) {
+        return build(adj, target, &weight);
+    }
+
+    int num_vertices() const { return (int)offsets_.size() - 1; }
+    int64_t num_edges() const { return offsets_.back(); }
+    bool weighted() const { return !weight_.empty(); }
+    int degree(int u) const { return (int)(offsets_[u + 1] - offsets_[u]); }
+    size_t bytes() const {
+        return offsets_.size() * sizeof(int64_t) + dest_.size() * sizeof(int) + weight_.size() * sizeof(int);
+    }
+
+    const int* targets(int u) const { return dest_.data() + offsets_[u]; }
+    const int* weights(int u) const { return weight_.data() + offsets_[u]; }
+
+    template <typename F>
+    void for_each_neighbor(int u, F&& f) const {
+        for (int64_t e = offsets_[u]; e < offsets_[u + 1]; ++e) f(dest_[e]);
+    }
+
+    template <typename F>
+    void for_each_edge(int u, F&& f) const {
+        detail::require_weights(weighted());
+        for (int64_t e = offsets_[u]; e < offsets_[u + 1]; ++e) f(dest_[e], weight_[e]);
+    }
+
+private:
+    struct NoWeight {
+        template <typename E>
+        int operator()(const E&) const { return 0; }
+    };
+
+    template <typename E, typename Target, typename Weight>
+    static CSR build(const std::vector<std::vector<E>>& adj, Target target, Weight* weight) {
+        const int n = (int)adj.size();
+        CSR g;
+        g.offsets_.assign(n + 1, 0);
+        for (int u = 0; u < n; ++u) g.offsets_[u + 1] = g.offsets_[u] + (int64_t)adj[u].size();
+        g.dest_.resize(g.offsets_[n]);
+        if (weight) g.weight_.resize(g.offsets_[n]);
+
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (int u = 0; u < n; ++u) {
+            const int64_t base = g.offsets_[u];
+            std::vector<std::pair<int, int>> list;
+            list.reserve(adj[u].size());
+            for (const E& e : adj[u]) list.push_back({target(e), weight ? (*weight)(e) : 0});
+            std::sort(list.begin(), list.end());
+            for (size_t i = 0; i < list.size(); ++i) {
+                g.dest_[base + i] = list[i].first;
+                if (weight) g.weight_[base + i] = list[i].second;
+            }
+        }
+        return g;
+    }
+
+    std::vector<int64_t> offsets_;
+    std::vector<int> dest_;
+    std::vector<int> weight_;
+};
+
+namespace detail {
+
+inline int varint_size(uint32_t v) {
+    int n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        ++n;
+    }
+    return n;
+}
+
+inline uint8_t* write_varint(uint8_t* p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+inline uint32_t read_varint(const uint8_t*& p) {
+    uint32_t v = *p & 0x7f;
+    if (*p++ < 0x80) return v;
+    int shift = 7;
+    while (true) {
+        uint32_t b = *p++;
+        v |= (b & 0x7f) << shift;
+        if (b < 0x80) return v;
+        shift += 7;
+    }
+}
+
+// Parallel two-pass encoding: size(u) bytes per vertex, then write(u, p)
+template <typename Size, typename Write>
+void encode(int n, size_t padding, std::vector<uint64_t>& offsets, std::vector<uint8_t>& data, Size size, Write write) {
+    offsets.assign(n + 1, 0);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int u = 0; u < n; ++u) offsets[u + 1] = size(u);
+    for (int u = 0; u < n; ++u) offsets[u + 1] += offsets[u];
+    data.assign(offsets[n] + padding, 0);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int u = 0; u < n; ++u) write(u, data.data() + offsets[u]);
+}
+
+} // namespace detail
+
+// Gap-encoded LEB128 varints, weights interleaved
+class VarintGraph {
+public:
+    explicit VarintGraph(const CSR& g) : weighted_(g.weighted()), edges_(g.num_edges()) {
+        auto size = [&](int u) {
+            const int* t = g.targets(u);
+            uint64_t bytes = 0;
+            for (int i = 0, prev = 0; i < g.degree(u); prev = t[i], ++i) {
+                bytes += detail::varint_size((uint32_t)(t[i] - prev));
+                if (weighted_) bytes += detail::varint_size((uint32_t)g.weights(u)[i]);
+            }
+            return bytes;
+        };
+        auto write = [&](int u, uint8_t* p) {
+            const int* t = g.targets(u);
+            for (int i = 0, prev = 0; i < g.degree(u); prev = t[i], ++i) {
+                p = detail::write_varint(p, (uint32_t)(t[i] - prev));
+                if (weighted_) p = detail::write_varint(p, (uint32_t)g.weights(u)[i]);
+            }
+        };
+        detail::encode(g.num_vertices(), 0, offsets_, data_, size, write);
+    }
+
+    int num_vertices() const { return (int)offsets_.size() - 1; }
+    int64_t num_edges() const { return edges_; }
+    bool weighted() const { return weighted_; }
+    size_t bytes() const { return offsets_.size() * sizeof(uint64_t) + data_.size(); }
+
+    template <typename F>
+    void for_each_neighbor(int u, F&& f) const {
+        const uint8_t* p = data_.data() + offsets_[u];
+        const uint8_t* end = data_.data() + offsets_[u + 1];
+        uint32_t v = 0;
+        while (p < end) {
+            v += detail::read_varint(p);
+            if (weighted_) detail::read_varint(p);
+            f((int)v);
+        }
+    }
+
+    template <typename F>
+    void for_each_edge(int u, F&& f) const {
+        detail::require_weights(weighted_);
+        const uint8_t* p = data_.data() + offsets_[u];
+        const uint8_t* end = data_.data() + offsets_[u + 1];
+        uint32_t v = 0;
+        while (p < end) {
+            v += detail::read_varint(p);
+            f((int)v, (int)detail::read_varint(p));
+        }
+    }
+
+private:
+    bool weighted_;
+    int64_t edges_;
+    std::vector<uint64_t> offsets_; // byte offset of each list
+    std::vector<uint8_t> data_;
+};
+
+// Stream VByte: per vertex [varint degree][control bytes][data bytes],
+// followed by a second control/data block for the weights
+class StreamVByteGraph {
+public:
+    explicit StreamVByteGraph(const CSR& g) : weighted_(g.weighted()), edges_(g.num_edges()) {
+        auto size = [&](int u) {
+            const int d = g.degree(u);
+            const int* t = g.targets(u);
+            uint64_t bytes = detail::varint_size((uint32_t)d) + (weighted_ ? 2 : 1) * ((d + 3) / 4);
+            for (int i = 0, prev = 0; i < d; prev = t[i], ++i) {
+                bytes += value_size((uint32_t)(t[i] - prev));
+                if (weighted_) bytes += value_size((uint32_t)g.weights(u)[i]);
+            }
+            return bytes;
+        };
+        auto write = [&](int u, uint8_t* p) {
+            const int d = g.degree(u);
+            p = detail::write_varint(p, (uint32_t)d);
+            const int* t = g.targets(u);
+            std::vector<uint32_t> values(d);
+            for (int i = 0, prev = 0; i < d; prev = t[i], ++i) values[i] = (uint32_t)(t[i] - prev);
+            p = write_stream(p, values);
+            if (weighted_) {
+                for (int i = 0; i < d; ++i) values[i] = (uint32_t)g.weights(u)[i];
+                write_stream(p, values);
+            }
+        };
+        // Padding keeps the 16-byte loads of the last group inside the buffer
+        detail::encode(g.num_vertices(), 16, offsets_, data_, size, write);
+    }
+
+    int num_vertices() const { return (int)offsets_.size() - 1; }
+    int64_t num_edges() const { return edges_; }
+    bool weighted() const { return weighted_; }
+    size_t bytes() const { return offsets_.size() * sizeof(uint64_t) + data_.size(); }
+
+    template <typename F>
+    void for_each_neighbor(int u, F&& f) const {
+        const uint8_t* p = data_.data() + offsets_[u];
+        const int d = (int)detail::read_varint(p);
+        const uint8_t* control = p;
+        const uint8_t* values = p + (d + 3) / 4;
+        uint32_t prev = 0;
+        uint32_t v[4];
+        int i = 0;
+        for (; i + 4 <= d; i += 4) {
+            values = decode_group(control[i / 4], values, v, prev);
+            f((int)v[0]);
+            f((int)v[1]);
+            f((int)v[2]);
+            f((int)v[3]);
+        }
+        for (; i < d; ++i) {
+            prev += decode_value(control[i / 4] >> (2 * (i % 4)), values);
+            f((int)prev);
+        }
+    }
+
+    template <typename F>
+    void for_each_edge(int u, F&& f) const {
+        detail::require_weights(weighted_);
+        const uint8_t* p = data_.data() + offsets_[u];
+        const int d = (int)detail::read_varint(p);
+        const int groups = (d + 3) / 4;
+        const uint8_t* control = p;
+        const uint8_t* values = p + groups;
+        // The weight block starts after the target data
+        const uint8_t* weight_control = values;
+        for (int k = 0; k < groups; ++k) weight_control += group_size(control[k], k == groups - 1 ? d - 4 * k : 4);
+        const uint8_t* weight_values = weight_control + groups;
+
+        uint32_t prev = 0, unused = 0;
+        uint32_t v[4], w[4];
+        int i = 0;
+        for (; i + 4 <= d; i += 4) {
+            values = decode_group(control[i / 4], values, v, prev);
+            weight_values = decode_group(weight_control[i / 4], weight_values, w, unused, false);
+            for (int k = 0; k < 4; ++k) f((int)v[k], (int)w[k]);
+        }
+        for (; i < d; ++i) {
+            prev += decode_value(control[i / 4] >> (2 * (i % 4)), values);
+            f((int)prev, (int)decode_value(weight_control[i / 4] >> (2 * (i % 4)), weight_values));
+        }
+    }
+
+private:
+    static int value_size(uint32_t v) { return v < (1u << 8) ? 1 : v < (1u << 16) ? 2 : v < (1u << 24) ? 3 : 4; }
+
+    static uint8_t* write_stream(uint8_t* p, const std::vector<uint32_t>& values) {
+        const int d = (int)values.size();
+        uint8_t* control = p;
+        uint8_t* data = p + (d + 3) / 4;
+        memset(control, 0, (d + 3) / 4);
+        for (int i = 0; i < d; ++i) {
+            const int size = value_size(values[i]);
+            control[i / 4] |= (uint8_t)((size - 1) << (2 * (i % 4)));
+            memcpy(data, &values[i], size); // little endian
+            data += size;
+        }
+        return data;
+    }
+
+    // Data bytes of the first `count` values of a group
+    static int group_size(uint8_t control, int count) {
+        int size = 0;
+        for (int k = 0; k < count; ++k) size += ((control >> (2 * k)) & 3) + 1;
+        return size;
+    }
+
+    // One value; code holds its 2-bit length in the low bits
+    static uint32_t decode_value(int code, const uint8_t*& p) {
+        const int size = (code & 3) + 1;
+        uint32_t v = 0;
+        memcpy(&v, p, size);
+        p += size;
+        return v;
+    }
+
+    struct Tables {
+        uint8_t shuffle[256][16];
+        uint8_t length[256];
+
+        Tables() {
+            for (int c = 0; c < 256; ++c) {
+                int src = 0;
+                for (int k = 0; k < 4; ++k) {
+                    const int size = ((c >> (2 * k)) & 3) + 1;
+                    for (int b = 0; b < 4; ++b) shuffle[c][4 * k + b] = b < size ? (uint8_t)src++ : 0x80;
+                }
+                length[c] = (uint8_t)src;
+            }
+        }
+    };
+
+    static const Tables& tables() {
+        static const Tables t;
+        return t;
+    }
+
+    // Four values of one control byte; with gaps, adds the running prefix
+    static const uint8_t* decode_group(uint8_t control, const uint8_t* p, uint32_t* out, uint32_t& prev,
+                                       bool gaps = true) {
+        const Tables& t = tables();
+#if defined(__SSSE3__)
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)p),
+                                     _mm_loadu_si128((const __m128i*)t.shuffle[control]));
+        if (gaps) {
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi32(v, _mm_set1_epi32((int)prev));
+        }
+        _mm_storeu_si128((__m128i*)out, v);
+#else
+        const uint8_t* q = p;
+        for (int k = 0; k < 4; ++k) out[k] = decode_value(control >> (2 * k), q);
+        if (gaps) {
+            out[0] += prev;
+            for (int k = 1; k < 4; ++k) out[k] += out[k - 1];
+        }
+#endif
+        if (gaps) prev = out[3];
+        return p + t.length[control];
+    }
+
+    bool weighted_;
+    int64_t edges_;
+    std::vector<uint64_t> offsets_; // byte offset of each vertex's block
+    std::vector<uint8_t> data_;
+};
+
+} // namespace cgraph
+
+#endif // COMPRESSED_GRAPH_H
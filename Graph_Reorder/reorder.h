@@ -0,0 +1,564 @@
+#ifndef REORDER_H
+#define REORDER_H
+
+// Vertex reordering for cache locality of adjacency-list graphs.
+//
+//   reorder::Permutation p = reorder::compute("rcm", graph.adj);
+//   Graph relabeled(graph.V);
+//   relabeled.adj = reorder::relabel(graph.adj, p);
+//   vector<int> order = bfs_seq(relabeled, p.new_id[start]);
+//   p.to_original_ids(order);                  // back to the input's ids
+//
+// Random vertex ids scatter each neighbour list over the whole vertex range.
+// Renumbering so that neighbours get nearby ids makes the per-vertex arrays
+// (visited, dist, ...) and the lists themselves hit the same cache lines and
+// pages. The methods treat every edge u->v as undirected:
+//
+// - rcm: Reverse Cuthill-McKee. BFS from a pseudo-peripheral vertex of each
+//   component. Every level is ordered by the position of a vertex's first
+//   parent, then by degree, and the final order is reversed. Large levels,
+//   of the pseudo-peripheral search as well as of the numbering, are
+//   expanded in parallel, and the degree sorts run in parallel. The result
+//   equals rcm_seq, the sequential queue-based algorithm, which
+//   check_rcm compares by bandwidth and profile.
+// - degree: hub sort. Vertices of above-average degree come first, by
+//   descending degree; the rest keep their order. Cheapest of the three.
+// - gorder: greedy Gorder. Repeatedly places the vertex with the most
+//   neighbours and shared neighbours among the last `window` placed ones.
+//   Shared neighbours through hubs are not counted, which bounds the cost.
+//   Sequential and the slowest to compute.
+//
+// Lists of plain ids work as they are. For edge structs pass an accessor
+// returning a reference to the target id: [](auto& e) -> auto& { return e.dest; }.
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+#include <omp.h>
+
+namespace reorder {
+
+// Levels (and sorts) smaller than this run without a parallel region
+const int64_t PARALLEL_LEVEL = 4096;
+
+struct Identity {
+    int& operator()(int& v) const { return v; }
+    const int& operator()(const int& v) const { return v; }
+};
+
+// new_id[old] = new, old_id[new] = old
+struct Permutation {
+    std::vector<int> new_id;
+    std::vector<int> old_id;
+
+    // order[i] is the original id of the vertex placed at position i
+    static Permutation from_order(std::vector<int> order) {
+        Permutation p;
+        p.old_id = std::move(order);
+        const int n = (int)p.old_id.size();
+        p.new_id.resize(n);
+        #pragma omp parallel for
+        for (int i = 0; i < n; ++i) p.new_id[p.old_id[i]] = i;
+        return p;
+    }
+
+    int size() const { return (int)new_id.size(); }
+
+    // Per-vertex values indexed by new id, re-indexed by original id
+    template <typename T>
+    std::vector<T> to_original(const std::vector<T>& values) const {
+        std::vector<T> out(values.size());
+        #pragma omp parallel for
+        for (int v = 0; v < (int)values.size(); ++v) out[old_id[v]] = values[v];
+        return out;
+    }
+
+    // Vertex ids (e.g. a traversal order) translated to original ids
+    void to_original_ids(std::vector<int>& ids) const {
+        #pragma omp parallel for
+        for (int64_t i = 0; i < (int64_t)ids.size(); ++i) ids[i] = old_id[ids[i]];
+    }
+};
+
+// Undirected, duplicate-free CSR view of a graph
+struct Symmetric {
+    int n = 0;
+    std::vector<int64_t> offsets;
+    std::vector<int> nbr;
+
+    int degree(int v) const { return (int)(offsets[v + 1] - offsets[v]); }
+    const int* begin(int v) const { return nbr.data() + offsets[v]; }
+    const int* end(int v) const { return nbr.data() + offsets[v + 1]; }
+};
+
+template <typename E, typename Target = Identity>
+Symmetric symmetrize(const std::vector<std::vector<E>>& adj, Target target = Target()) {
+    const int n = (int)adj.size();
+    std::vector<int64_t> count(n + 1, 0);
+
+    // Out-degree plus in-degree, self-loops dropped
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int u = 0; u < n; ++u) {
+        for (const E& e : adj[u]) {
+            int v = target(e);
+            if (v == u) continue;
+            #pragma omp atomic
+            count[u + 1]++;
+            #pragma omp atomic
+            count[v + 1]++;
+        }
+    }
+    for (int v = 0; v < n; ++v) count[v + 1] += count[v];
+
+    std::vector<int> raw(count[n]);
+    std::vector<int64_t> fill(count.begin(), count.end() - 1);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int u = 0; u < n; ++u) {
+        for (const E& e : adj[u]) {
+            int v = target(e);
+            if (v == u) continue;
+            int64_t a, b;
+            #pragma omp atomic capture
+            a = fill[u]++;
+            #pragma omp atomic capture
+            b = fill[v]++;
+            raw[a] = v;
+            raw[b] = u;
+        }
+    }
+
+    // Sort each list and drop duplicates (u->v together with v->u)
+    std::vector<int64_t> unique_count(n + 1, 0);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int v = 0; v < n; ++v) {
+        int* first = raw.data() + count[v];
+        int* last = raw.data() + count[v + 1];
+        std::sort(first, last);
+        unique_count[v + 1] = std::unique(first, last) - first;
+    }
+
+    Symmetric g;
+    g.n = n;
+    g.offsets.assign(n + 1, 0);
+    for (int v = 0; v < n; ++v) g.offsets[v + 1] = g.offsets[v] + unique_count[v + 1];
+    g.nbr.resize(g.offsets[n]);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int v = 0; v < n; ++v) {
+        std::copy(raw.begin() + count[v], raw.begin() + count[v] + unique_count[v + 1], g.nbr.begin() + g.offsets[v]);
+    }
+    return g;
+}
+
+namespace detail {
+
+// Stable sort: every thread sorts one block, then neighbouring blocks are
+// merged pairwise, all pairs of a round in parallel
+template <typename T, typename Less>
+void parallel_stable_sort(std::vector<T>& a, Less less) {
+    const int64_t n = (int64_t)a.size();
+    const int blocks = (int)std::max<int64_t>(1, std::min<int64_t>(omp_get_max_threads(), n / PARALLEL_LEVEL));
+    if (blocks == 1) {
+        std::stable_sort(a.begin(), a.end(), less);
+        return;
+    }
+    std::vector<int64_t> bounds(blocks + 1);
+    for (int b = 0; b <= blocks; ++b) bounds[b] = n * b / blocks;
+    #pragma omp parallel for
+    for (int b = 0; b < blocks; ++b) std::stable_sort(a.begin() + bounds[b], a.begin() + bounds[b + 1], less);
+
+    std::vector<T> merged(n);
+    for (int width = 1; width < blocks; width *= 2) {
+        #pragma omp parallel for
+        for (int b = 0; b < blocks; b += 2 * width) {
+            const int mid = std::min(b + width, blocks), end = std::min(b + 2 * width, blocks);
+            std::merge(a.begin() + bounds[b], a.begin() + bounds[mid], a.begin() + bounds[mid], a.begin() + bounds[end],
+                       merged.begin() + bounds[b], less);
+        }
+        a.swap(merged);
+    }
+}
+
+// All vertices, stably sorted by less
+template <typename Less>
+std::vector<int> sorted_vertices(int n, Less less) {
+    std::vector<int> order(n);
+    #pragma omp parallel for
+    for (int v = 0; v < n; ++v) order[v] = v;
+    parallel_stable_sort(order, less);
+    return order;
+}
+
+// BFS from root over unvisited vertices; returns the last level. The
+// touched vertices' dist entries are reset before returning. Only the
+// order of the returned level depends on the thread count.
+inline std::vector<int> last_level(const Symmetric& g, int root, const std::vector<char>& visited,
+                                   std::vector<std::atomic<int>>& dist, int& eccentricity, int64_t parallel_level) {
+    std::vector<int> touched = {root}, level = {root}, next;
+    dist[root].store(0, std::memory_order_relaxed);
+    eccentricity = 0;
+    while (true) {
+        next.clear();
+        const int64_t m = (int64_t)level.size();
+        const int depth = eccentricity + 1;
+        #pragma omp parallel if (m > parallel_level)
+        {
+            std::vector<int> local;
+            #pragma omp for schedule(dynamic, 64) nowait
+            for (int64_t i = 0; i < m; ++i) {
+                const int u = level[i];
+                for (const int* p = g.begin(u); p != g.end(u); ++p) {
+                    int unseen = -1;
+                    if (!visited[*p] && dist[*p].load(std::memory_order_relaxed) < 0 &&
+                        dist[*p].compare_exchange_strong(unseen, depth, std::memory_order_relaxed)) {
+                        local.push_back(*p);
+                    }
+                }
+            }
+            #pragma omp critical
+            next.insert(next.end(), local.begin(), local.end());
+        }
+        if (next.empty()) break;
+        touched.insert(touched.end(), next.begin(), next.end());
+        level.swap(next);
+        eccentricity++;
+    }
+    const int64_t t = (int64_t)touched.size();
+    #pragma omp parallel for if (t > parallel_level)
+    for (int64_t i = 0; i < t; ++i) dist[touched[i]].store(-1, std::memory_order_relaxed);
+    return level;
+}
+
+// George-Liu: move to a minimum-degree vertex of the last BFS level while
+// that increases the eccentricity. Ties go to the smallest id, so the
+// root does not depend on the order the level was found in.
+inline int pseudo_peripheral(const Symmetric& g, int seed, const std::vector<char>& visited,
+                             std::vector<std::atomic<int>>& dist, int64_t parallel_level) {
+    int root = seed, ecc;
+    std::vector<int> last = last_level(g, root, visited, dist, ecc, parallel_level);
+    for (int iter = 0; iter < 8; ++iter) {
+        int candidate = last[0];
+        for (int v : last) {
+            if (g.degree(v) < g.degree(candidate) || (g.degree(v) == g.degree(candidate) && v < candidate)) candidate = v;
+        }
+        int candidate_ecc;
+        std::vector<int> candidate_last = last_level(g, candidate, visited, dist, candidate_ecc, parallel_level);
+        if (candidate_ecc <= ecc) break;
+        root = candidate;
+        ecc = candidate_ecc;
+        last.swap(candidate_last);
+    }
+    return root;
+}
+
+// Cuthill-McKee order of the children of one vertex
+struct DegreeThenId {
+    const Symmetric& g;
+    bool operator()(int a, int b) const { return g.degree(a) != g.degree(b) ? g.degree(a) < g.degree(b) : a < b; }
+};
+
+} // namespace detail
+
+inline Permutation rcm(const Symmetric& g) {
+    const int n = g.n;
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<char> visited(n, 0);
+    std::vector<std::atomic<int>> dist(n);
+    std::vector<std::atomic<int>> parent(n);
+    #pragma omp parallel for
+    for (int v = 0; v < n; ++v) {
+        dist[v].store(-1, std::memory_order_relaxed);
+        parent[v].store(INT_MAX, std::memory_order_relaxed);
+    }
+
+    // Component seeds: unvisited vertex of smallest degree
+    const std::vector<int> by_degree =
+        detail::sorted_vertices(n, [&](int a, int b) { return g.degree(a) < g.degree(b); });
+
+    size_t scan = 0;
+    while ((int)order.size() < n) {
+        while (visited[by_degree[scan]]) ++scan;
+        const int root = detail::pseudo_peripheral(g, by_degree[scan], visited, dist, PARALLEL_LEVEL);
+
+        std::vector<int> frontier = {root};
+        visited[root] = 1;
+        order.push_back(root);
+        while (!frontier.empty()) {
+            const int64_t m = (int64_t)frontier.size();
+
+            // Every unvisited neighbour claims its earliest parent in the level
+            #pragma omp parallel for schedule(dynamic, 64) if (m > PARALLEL_LEVEL)
+            for (int64_t i = 0; i < m; ++i) {
+                const int u = frontier[i];
+                for (const int* p = g.begin(u); p != g.end(u); ++p) {
+                    if (visited[*p]) continue;
+                    int cur = parent[*p].load(std::memory_order_relaxed);
+                    while (i < cur && !parent[*p].compare_exchange_weak(cur, (int)i, std::memory_order_relaxed)) {
+                    }
+                }
+            }
+
+            // Collect children in parent order (lists are duplicate-free, so
+            // each child is found exactly once). Static chunks in thread
+            // order keep the parents ascending; each parent's children are
+            // sorted by degree as they are collected.
+            std::vector<std::vector<int>> parts;
+            #pragma omp parallel if (m > PARALLEL_LEVEL)
+            {
+                #pragma omp single
+                parts.resize(omp_get_num_threads());
+                std::vector<int>& local = parts[omp_get_thread_num()];
+                #pragma omp for schedule(static)
+                for (int64_t i = 0; i < m; ++i) {
+                    const int u = frontier[i];
+                    const size_t first = local.size();
+                    for (const int* p = g.begin(u); p != g.end(u); ++p) {
+                        if (!visited[*p] && parent[*p].load(std::memory_order_relaxed) == i) local.push_back(*p);
+                    }
+                    std::sort(local.begin() + first, local.end(), detail::DegreeThenId{g});
+                }
+            }
+            std::vector<int> next;
+            for (auto& part : parts) next.insert(next.end(), part.begin(), part.end());
+
+            const int64_t k = (int64_t)next.size();
+            #pragma omp parallel for if (k > PARALLEL_LEVEL)
+            for (int64_t i = 0; i < k; ++i) visited[next[i]] = 1;
+            order.insert(order.end(), next.begin(), next.end());
+            frontier.swap(next);
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return Permutation::from_order(std::move(order));
+}
+
+// Textbook Cuthill-McKee with a FIFO queue, entirely sequential: the
+// reference that rcm must match
+inline Permutation rcm_seq(const Symmetric& g) {
+    const int n = g.n;
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<char> visited(n, 0);
+    std::vector<std::atomic<int>> dist(n);
+    for (int v = 0; v < n; ++v) dist[v].store(-1, std::memory_order_relaxed);
+
+    std::vector<int> by_degree(n);
+    for (int v = 0; v < n; ++v) by_degree[v] = v;
+    std::stable_sort(by_degree.begin(), by_degree.end(), [&](int a, int b) { return g.degree(a) < g.degree(b); });
+
+    size_t scan = 0;
+    while ((int)order.size() < n) {
+        while (visited[by_degree[scan]]) ++scan;
+        const int root = detail::pseudo_peripheral(g, by_degree[scan], visited, dist, INT64_MAX);
+        visited[root] = 1;
+        order.push_back(root);
+        for (size_t head = order.size() - 1; head < order.size(); ++head) {
+            const int u = order[head];
+            const size_t first = order.size();
+            for (const int* p = g.begin(u); p != g.end(u); ++p) {
+                if (!visited[*p]) {
+                    visited[*p] = 1;
+                    order.push_back(*p);
+                }
+            }
+            std::sort(order.begin() + first, order.end(), detail::DegreeThenId{g});
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return Permutation::from_order(std::move(order));
+}
+
+inline Permutation degree_sort(const Symmetric& g) {
+    const int n = g.n;
+    const double average = n > 0 ? (double)g.offsets[n] / n : 0.0;
+    // One stable sort: hubs by their degree, every other vertex by 0
+    auto key = [&](int v) { return g.degree(v) > average ? g.degree(v) : 0; };
+    return Permutation::from_order(detail::sorted_vertices(n, [&](int a, int b) { return key(a) > key(b); }));
+}
+
+// Keys that only ever change by one, bucketed by value (Gorder's "unit
+// heap"): increment, decrement, remove and find-max are all O(1)
+class UnitHeap {
+public:
+    // Vertices start at key 0, in the given order
+    explicit UnitHeap(const std::vector<int>& initial)
+        : key_(initial.size(), 0), prev_(initial.size(), -1), next_(initial.size(), -1), head_(1, -1) {
+        for (auto it = initial.rbegin(); it != initial.rend(); ++it) link(*it);
+    }
+
+    bool empty() const { return size_ == 0; }
+
+    int top() {
+        while (head_[top_] < 0) --top_;
+        return head_[top_];
+    }
+
+    void increment(int v) {
+        unlink(v);
+        if (++key_[v] == (int)head_.size()) head_.push_back(-1);
+        top_ = std::max(top_, key_[v]);
+        link(v);
+    }
+
+    void decrement(int v) {
+        unlink(v);
+        --key_[v];
+        link(v);
+    }
+
+    void remove(int v) {
+        unlink(v);
+        key_[v] = -1;
+    }
+
+    bool contains(int v) const { return key_[v] >= 0; }
+
+private:
+    void link(int v) {
+        int& h = head_[key_[v]];
+        prev_[v] = -1;
+        next_[v] = h;
+        if (h >= 0) prev_[h] = v;
+        h = v;
+        ++size_;
+    }
+
+    void unlink(int v) {
+        if (prev_[v] >= 0) next_[prev_[v]] = next_[v];
+        else head_[key_[v]] = next_[v];
+        if (next_[v] >= 0) prev_[next_[v]] = prev_[v];
+        --size_;
+    }
+
+    std::vector<int> key_, prev_, next_;
+    std::vector<int> head_; // first vertex of each key
+    int top_ = 0;
+    int64_t size_ = 0;
+};
+
+inline Permutation gorder(const Symmetric& g, int window = 5) {
+    const int n = g.n;
+    // Vertices above this degree are not expanded for shared-neighbour scores
+    const int hub_degree = std::max(64, (int)std::sqrt((double)n));
+
+    // Ties (including a window with no unplaced neighbours) go to the
+    // highest-degree vertex left
+    UnitHeap heap(detail::sorted_vertices(n, [&](int a, int b) { return g.degree(a) > g.degree(b); }));
+
+    // Adds (or removes) v's contribution to the keys of unplaced vertices
+    auto update = [&](int v, bool add) {
+        auto bump = [&](int u) {
+            if (!heap.contains(u)) return;
+            if (add) heap.increment(u);
+            else heap.decrement(u);
+        };
+        for (const int* p = g.begin(v); p != g.end(v); ++p) {
+            bump(*p);
+            if (g.degree(*p) > hub_degree) continue;
+            for (const int* q = g.begin(*p); q != g.end(*p); ++q) {
+                if (*q != v) bump(*q);
+            }
+        }
+    };
+
+    std::vector<int> order;
+    order.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        const int v = heap.top();
+        heap.remove(v);
+        order.push_back(v);
+        update(v, true);
+        if (i >= window) update(order[i - window], false);
+    }
+    return Permutation::from_order(std::move(order));
+}
+
+inline bool is_method(const std::string& name) {
+    return name == "rcm" || name == "degree" || name == "gorder";
+}
+
+// Method by name: "rcm", "degree" or "gorder"
+template <typename E, typename Target = Identity>
+Permutation compute(const std::string& method, const std::vector<std::vector<E>>& adj, Target target = Target()) {
+    Symmetric g = symmetrize(adj, target);
+    if (method == "rcm") return rcm(g);
+    if (method == "degree") return degree_sort(g);
+    return gorder(g);
+}
+
+// Adjacency lists renumbered by p; each list is sorted by the new target id
+template <typename E, typename Target = Identity>
+std::vector<std::vector<E>> relabel(const std::vector<std::vector<E>>& adj, const Permutation& p, Target target = Target()) {
+    const int n = (int)adj.size();
+    std::vector<std::vector<E>> out(n);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int nu = 0; nu < n; ++nu) {
+        std::vector<E> list = adj[p.old_id[nu]];
+        for (E& e : list) target(e) = p.new_id[target(e)];
+        std::sort(list.begin(), list.end(), [&](const E& a, const E& b) { return target(a) < target(b); });
+        out[nu] = std::move(list);
+    }
+    return out;
+}
+
+// Bandwidth (largest |new(u) - new(v)| over all edges) and profile (sum
+// over rows of the distance from the diagonal to the leftmost entry) of
+// the symmetric adjacency matrix under p. RCM aims to make both small.
+struct Envelope {
+    int64_t bandwidth = 0;
+    int64_t profile = 0;
+};
+
+inline Envelope envelope(const Symmetric& g, const Permutation& p) {
+    int64_t bandwidth = 0, profile = 0;
+    #pragma omp parallel for schedule(dynamic, 256) reduction(max : bandwidth) reduction(+ : profile)
+    for (int v = 0; v < g.n; ++v) {
+        const int row = p.new_id[v];
+        int leftmost = row;
+        for (const int* q = g.begin(v); q != g.end(v); ++q) {
+            const int col = p.new_id[*q];
+            leftmost = std::min(leftmost, col);
+            bandwidth = std::max<int64_t>(bandwidth, std::abs(col - row));
+        }
+        profile += row - leftmost;
+    }
+    return {bandwidth, profile};
+}
+
+// An rcm permutation against rcm_seq on the same graph
+struct RcmCheck {
+    Envelope par, seq;
+    bool ok() const { return par.bandwidth <= seq.bandwidth && par.profile <= seq.profile; }
+};
+
+template <typename E, typename Target = Identity>
+RcmCheck check_rcm(const std::vector<std::vector<E>>& adj, const Permutation& p, Target target = Target()) {
+    Symmetric g = symmetrize(adj, target);
+    return {envelope(g, p), envelope(g, rcm_seq(g))};
+}
+
+// Mean |u - v| over all edges: how far apart in memory neighbours are
+template <typename E, typename Target = Identity>
+double average_gap(const std::vector<std::vector<E>>& adj, Target target = Target()) {
+    const int n = (int)adj.size();
+    double total = 0.0;
+    int64_t edges = 0;
+    #pragma omp parallel for schedule(dynamic, 256) reduction(+ : total, edges)
+    for (int u = 0; u < n; ++u) {
+        for (const E& e : adj[u]) total += std::abs(target(e) - u);
+        edges += (int64_t)adj[u].size();
+    }
+    return edges > 0 ? total / edges : 0.0;
+}
+
+} // namespace reorder
+
+#endif // REORDER_H
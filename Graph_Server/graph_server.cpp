@@ -0,0 +1,662 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <fstream>
+#include <deque>
+#include <map>
+#include <queue>
+#include <tuple>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <limits>
+#include <memory>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include "../Work_Stealing/work_stealing.h"
+#include "../Benchmark/bench.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// Weighted directed graph in compressed sparse row form
+struct CSRGraph {
+    int V = 0;
+    vector<long long> offsets; // V + 1 entries
+    vector<int> dest;
+    vector<int> weight;
+
+    long long num_edges() const { return (long long)dest.size(); }
+};
+
+// Edges as (src, dest, weight); sorted into CSR by a counting pass
+CSRGraph build_csr(int vertices, const vector<tuple<int, int, int>>& edges) {
+    CSRGraph g;
+    g.V = vertices;
+    g.offsets.assign(vertices + 1, 0);
+    for (const auto& e : edges) g.offsets[get<0>(e) + 1]++;
+    for (int v = 0; v < vertices; ++v) g.offsets[v + 1] += g.offsets[v];
+
+    g.dest.resize(edges.size());
+    g.weight.resize(edges.size());
+    vector<long long> next(g.offsets.begin(), g.offsets.end() - 1);
+    for (const auto& e : edges) {
+        long long pos = next[get<0>(e)]++;
+        g.dest[pos] = get<1>(e);
+        g.weight[pos] = get<2>(e);
+    }
+    return g;
+}
+
+// Same shape as the Dijkstra program's generator, but seeded and sequential
+// so a given seed always produces the same graph
+CSRGraph generate_graph(int vertices, int edge_density, int min_weight, int max_weight, unsigned seed) {
+    mt19937 gen(seed);
+    uniform_int_distribution<> dest_dist(0, vertices - 1);
+    uniform_int_distribution<> weight_dist(min_weight, max_weight);
+
+    vector<tuple<int, int, int>> edges;
+    edges.reserve((size_t)vertices * edge_density);
+    for (int i = 0; i < vertices; ++i) {
+        for (int j = 0; j < edge_density; ++j) {
+            int dest = dest_dist(gen);
+            // Avoid self-loops
+            if (dest == i) dest = (dest < vertices - 1) ? dest + 1 : dest - 1;
+            edges.emplace_back(i, dest, weight_dist(gen));
+        }
+    }
+    return build_csr(vertices, edges);
+}
+
+// Edge list file: "src dest [weight]" per line, '#' starts a comment
+bool load_graph(const string& path, CSRGraph& g, string& error) {
+    ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    vector<tuple<int, int, int>> edges;
+    int max_id = -1;
+    string line;
+    long long line_no = 0;
+    while (getline(in, line)) {
+        ++line_no;
+        line = line.substr(0, line.find('#'));
+        istringstream ss(line);
+        long long u, v, w = 1;
+        if (!(ss >> u)) continue;
+        if (!(ss >> v) || u < 0 || v < 0 || u > INT32_MAX - 1 || v > INT32_MAX - 1) {
+            error = path + ":" + to_string(line_no) + ": expected 'src dest [weight]'";
+            return false;
+        }
+        // The weight is optional, but if present it must be a number
+        if (!(ss >> std::ws).eof() && (!(ss >> w) || !(ss >> std::ws).eof())) {
+            error = path + ":" + to_string(line_no) + ": weight is not a number";
+            return false;
+        }
+        if (w < 0 || w > INT32_MAX) {
+            error = path + ":" + to_string(line_no) + ": weight out of range";
+            return false;
+        }
+        edges.emplace_back((int)u, (int)v, (int)w);
+        max_id = max(max_id, (int)max(u, v));
+    }
+    g = build_csr(max_id + 1, edges);
+    return true;
+}
+
+// BFS levels from src; -1 for unreachable vertices
+vector<int> bfs_levels(const CSRGraph& g, int src) {
+    vector<int> level(g.V, -1);
+    vector<int> frontier = {src}, next;
+    level[src] = 0;
+    for (int depth = 1; !frontier.empty(); ++depth) {
+        next.clear();
+        for (int u : frontier) {
+            for (long long e = g.offsets[u]; e < g.offsets[u + 1]; ++e) {
+                int v = g.dest[e];
+                if (level[v] < 0) {
+                    level[v] = depth;
+                    next.push_back(v);
+                }
+            }
+        }
+        frontier.swap(next);
+    }
+    return level;
+}
+
+const long long INF = numeric_limits<long long>::max();
+
+// Dijkstra with a binary heap
+vector<long long> shortest_paths(const CSRGraph& g, int src) {
+    vector<long long> dist(g.V, INF);
+    priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<pair<long long, int>>> pq;
+    dist[src] = 0;
+    pq.push({0, src});
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u]) continue;
+        for (long long e = g.offsets[u]; e < g.offsets[u + 1]; ++e) {
+            int v = g.dest[e];
+            long long nd = d + g.weight[e];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                pq.push({nd, v});
+            }
+        }
+    }
+    return dist;
+}
+
+// Log2-bucketed latency histogram in microseconds; lock-free to record
+class LatencyHistogram {
+public:
+    static const int BUCKETS = 40;
+
+    LatencyHistogram() {
+        for (auto& b : buckets_) b.store(0);
+    }
+
+    void record(double us) {
+        int b = 0;
+        while (b < BUCKETS - 1 && us >= (double)(1ull << b)) ++b;
+        buckets_[b].fetch_add(1, memory_order_relaxed);
+        count_.fetch_add(1, memory_order_relaxed);
+        double prev = max_us_.load(memory_order_relaxed);
+        while (us > prev && !max_us_.compare_exchange_weak(prev, us, memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const { return count_.load(); }
+    double max_us() const { return max_us_.load(); }
+
+    // Upper bound of the bucket holding the p-th percentile
+    double percentile(double p) const {
+        uint64_t total = count();
+        if (total == 0) return 0.0;
+        uint64_t rank = (uint64_t)(p / 100.0 * total + 0.5), seen = 0;
+        if (rank == 0) rank = 1;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += buckets_[b].load(memory_order_relaxed);
+            if (seen >= rank) return (double)(1ull << b);
+        }
+        return max_us();
+    }
+
+    // "<1us:n <2us:n <4us:n ..." for the non-empty buckets
+    string buckets() const {
+        ostringstream out;
+        for (int b = 0; b < BUCKETS; ++b) {
+            uint64_t n = buckets_[b].load(memory_order_relaxed);
+            if (n) out << (out.tellp() > 0 ? " " : "") << "<" << (1ull << b) << "us:" << n;
+        }
+        return out.str();
+    }
+
+private:
+    atomic<uint64_t> buckets_[BUCKETS];
+    atomic<uint64_t> count_{0};
+    atomic<double> max_us_{0.0};
+};
+
+// One client: reads requests from in_fd, responses go to out_fd. Responses
+// are written by pool workers as queries finish, so writes are serialised.
+// Set by SIGINT/SIGTERM
+atomic<bool> stop_requested(false);
+
+void handle_signal(int) { stop_requested.store(true); }
+
+class Connection {
+public:
+    Connection(int in_fd, int out_fd, bool is_socket) : in_fd_(in_fd), out_fd_(out_fd), is_socket_(is_socket) {}
+
+    ~Connection() {
+        if (is_socket_) close(in_fd_);
+    }
+
+    void send(const string& line) {
+        lock_guard<mutex> lock(write_mutex_);
+        string data = line + "\n";
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t n = is_socket_ ? ::send(out_fd_, data.data() + done, data.size() - done, MSG_NOSIGNAL)
+                                   : ::write(out_fd_, data.data() + done, data.size() - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return; // client went away
+            done += n;
+        }
+    }
+
+    // Next line without the newline; false at end of input
+    bool read_line(string& line) {
+        while (true) {
+            size_t nl = buffer_.find('\n');
+            if (nl != string::npos) {
+                line = buffer_.substr(0, nl);
+                buffer_.erase(0, nl + 1);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                return true;
+            }
+            if (stop_requested.load()) return false;
+            char chunk[4096];
+            ssize_t n = ::read(in_fd_, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) {
+                if (stop_requested.load()) return false; // interrupted by SIGINT/SIGTERM
+                continue;
+            }
+            if (n <= 0) {
+                if (buffer_.empty()) return false;
+                line.swap(buffer_);
+                buffer_.clear();
+                return true;
+            }
+            buffer_.append(chunk, n);
+        }
+    }
+
+    // Unblocks a pending read_line during shutdown
+    void interrupt() {
+        if (is_socket_) ::shutdown(in_fd_, SHUT_RD);
+    }
+
+private:
+    int in_fd_;
+    int out_fd_;
+    bool is_socket_;
+    mutex write_mutex_;
+    string buffer_;
+};
+
+enum class QueryKind { BFS, REACH, SSSP, DIST };
+
+struct Request {
+    shared_ptr<Connection> conn;
+    string id;
+    QueryKind kind;
+    int a;
+    int b;
+    steady_clock::time_point arrival;
+};
+
+// Collects requests into batches and hands each batch to the pool without
+// waiting for it, so up to one batch per worker is in flight and a slow
+// traversal only holds up the queries that share it. Queries in a batch
+// that need the same traversal (BFS/REACH from one source, or SSSP/DIST
+// from one source) share it; every query is answered as soon as its
+// traversal finishes.
+class QueryServer {
+public:
+    QueryServer(const CSRGraph& graph, int threads, int max_batch, int batch_delay_us)
+        : graph_(graph), pool_(threads), max_batch_(max_batch), batch_delay_(batch_delay_us),
+          batcher_([this] { batch_loop(); }) {}
+
+    ~QueryServer() { shutdown(); }
+
+    // Parses and queues one request line
+    void handle_line(const shared_ptr<Connection>& conn, const string& line) {
+        istringstream ss(line);
+        string id, cmd;
+        if (!(ss >> id)) return; // blank line
+        if (!(ss >> cmd)) {
+            conn->send(id + " ERR expected '<id> <command> [args]'");
+            return;
+        }
+        for (char& c : cmd) c = (char)toupper((unsigned char)c);
+
+        if (cmd == "STATS") {
+            conn->send(id + " OK " + stats());
+            return;
+        }
+
+        Request r{conn, id, QueryKind::BFS, -1, -1, steady_clock::now()};
+        int args = 1;
+        if (cmd == "BFS") r.kind = QueryKind::BFS;
+        else if (cmd == "SSSP") r.kind = QueryKind::SSSP;
+        else if (cmd == "REACH") { r.kind = QueryKind::REACH; args = 2; }
+        else if (cmd == "DIST") { r.kind = QueryKind::DIST; args = 2; }
+        else {
+            conn->send(id + " ERR unknown command " + cmd);
+            return;
+        }
+
+        long long a = -1, b = -1;
+        if (!(ss >> a) || (args == 2 && !(ss >> b))) {
+            conn->send(id + " ERR " + cmd + (args == 2 ? " needs <src> <dest>" : " needs <src>"));
+            return;
+        }
+        if (a < 0 || a >= graph_.V || (args == 2 && (b < 0 || b >= graph_.V))) {
+            conn->send(id + " ERR vertex out of range [0, " + to_string(graph_.V - 1) + "]");
+            return;
+        }
+        r.a = (int)a;
+        r.b = (int)b;
+
+        {
+            lock_guard<mutex> lock(queue_mutex_);
+            queue_.push_back(move(r));
+        }
+        queue_cv_.notify_one();
+    }
+
+    // Reads request lines until the client disconnects
+    void serve(const shared_ptr<Connection>& conn) {
+        string line;
+        while (conn->read_line(line)) {
+            if (line == "QUIT" || line == "quit") break;
+            handle_line(conn, line);
+        }
+    }
+
+    // Answers everything already queued, then stops the batcher
+    void shutdown() {
+        {
+            lock_guard<mutex> lock(queue_mutex_);
+            if (stopping_) return;
+            stopping_ = true;
+        }
+        queue_cv_.notify_all();
+        batcher_.join();
+        // The batcher has submitted its last batch; wait for the running ones
+        unique_lock<mutex> lock(queue_mutex_);
+        queue_cv_.wait(lock, [&] { return in_flight_ == 0; });
+    }
+
+    string stats() const {
+        ostringstream out;
+        const uint64_t batches = batches_.load();
+        out << "vertices=" << graph_.V << " edges=" << graph_.num_edges()
+            << " queries=" << latency_.count() << " batches=" << batches
+            << " traversals=" << traversals_.load();
+        if (batches) out << " avg_batch=" << fixed << setprecision(2) << (double)batched_.load() / batches;
+        out << " p50_us=" << (long long)latency_.percentile(50) << " p95_us=" << (long long)latency_.percentile(95)
+            << " p99_us=" << (long long)latency_.percentile(99) << " max_us=" << (long long)latency_.max_us();
+        return out.str();
+    }
+
+    const LatencyHistogram& latency() const { return latency_; }
+
+private:
+    void batch_loop() {
+        while (true) {
+            vector<Request> batch;
+            {
+                unique_lock<mutex> lock(queue_mutex_);
+                // With every worker busy, requests keep queueing and form a
+                // larger batch, which shares more traversals
+                queue_cv_.wait(lock, [&] { return (!queue_.empty() || stopping_) && in_flight_ < pool_.size(); });
+                if (queue_.empty()) return; // stopping and drained
+
+                // Give concurrent requests a moment to join the batch
+                if ((int)queue_.size() < max_batch_ && !stopping_) {
+                    queue_cv_.wait_for(lock, batch_delay_, [&] { return (int)queue_.size() >= max_batch_ || stopping_; });
+                }
+                while (!queue_.empty() && (int)batch.size() < max_batch_) {
+                    batch.push_back(move(queue_.front()));
+                    queue_.pop_front();
+                }
+                in_flight_++;
+            }
+            // Answers go out through each request's Connection, so the
+            // batcher does not wait and goes back to collecting requests
+            pool_.submit(ws::ThreadPool::make_task([this, batch = move(batch)]() mutable {
+                execute(batch);
+                // Notified under the lock: shutdown() may return, and the
+                // server be destroyed, as soon as the lock is released
+                lock_guard<mutex> lock(queue_mutex_);
+                in_flight_--;
+                queue_cv_.notify_all();
+            }));
+        }
+    }
+
+    struct Traversal {
+        bool weighted;
+        int src;
+        vector<int> waiters; // indices into the batch
+    };
+
+    void execute(vector<Request>& batch) {
+        // One traversal per distinct (kind of search, source)
+        vector<Traversal> traversals;
+        map<pair<bool, int>, int> index;
+        for (int i = 0; i < (int)batch.size(); ++i) {
+            const Request& r = batch[i];
+            bool weighted = r.kind == QueryKind::SSSP || r.kind == QueryKind::DIST;
+            auto it = index.find({weighted, r.a});
+            if (it == index.end()) {
+                it = index.emplace(make_pair(weighted, r.a), (int)traversals.size()).first;
+                traversals.push_back({weighted, r.a, {}});
+            }
+            traversals[it->second].waiters.push_back(i);
+        }
+
+        ws::parallel_for(pool_, 0, (int64_t)traversals.size(), [&](int64_t t) {
+            const Traversal& tr = traversals[t];
+            if (tr.weighted) {
+                vector<long long> dist = shortest_paths(graph_, tr.src);
+                for (int i : tr.waiters) respond(batch[i], answer_weighted(batch[i], dist));
+            } else {
+                vector<int> level = bfs_levels(graph_, tr.src);
+                for (int i : tr.waiters) respond(batch[i], answer_unweighted(batch[i], level));
+            }
+        }, 1);
+
+        batches_.fetch_add(1);
+        batched_.fetch_add(batch.size());
+        traversals_.fetch_add(traversals.size());
+    }
+
+    static string answer_unweighted(const Request& r, const vector<int>& level) {
+        if (r.kind == QueryKind::REACH) return level[r.b] >= 0 ? "1" : "0";
+        // BFS: number of vertices at each level
+        vector<long long> per_level;
+        long long reached = 0;
+        for (int l : level) {
+            if (l < 0) continue;
+            if (l >= (int)per_level.size()) per_level.resize(l + 1, 0);
+            per_level[l]++;
+            reached++;
+        }
+        ostringstream out;
+        out << "reached=" << reached << " depth=" << (int)per_level.size() - 1 << " levels=";
+        for (size_t l = 0; l < per_level.size(); ++l) out << (l ? "," : "") << per_level[l];
+        return out.str();
+    }
+
+    static string answer_weighted(const Request& r, const vector<long long>& dist) {
+        if (r.kind == QueryKind::DIST) return dist[r.b] == INF ? "INF" : to_string(dist[r.b]);
+        // SSSP: summary of the distance vector
+        long long reached = 0, max_dist = 0, sum = 0;
+        for (long long d : dist) {
+            if (d == INF) continue;
+            reached++;
+            max_dist = max(max_dist, d);
+            sum += d;
+        }
+        return "reached=" + to_string(reached) + " max=" + to_string(max_dist) + " sum=" + to_string(sum);
+    }
+
+    void respond(const Request& r, const string& result) {
+        r.conn->send(r.id + " OK " + result);
+        latency_.record(duration<double, micro>(steady_clock::now() - r.arrival).count());
+    }
+
+    const CSRGraph& graph_;
+    ws::ThreadPool pool_;
+    const int max_batch_;
+    const microseconds batch_delay_;
+
+    mutex queue_mutex_;
+    condition_variable queue_cv_;
+    deque<Request> queue_;
+    int in_flight_ = 0; // batches submitted to the pool and not yet answered
+    bool stopping_ = false;
+
+    LatencyHistogram latency_;
+    atomic<uint64_t> batches_{0}, batched_{0}, traversals_{0};
+
+    thread batcher_; // last: started once everything above exists
+};
+
+// Accepts clients on a Unix domain socket until SIGINT/SIGTERM
+int serve_socket(QueryServer& server, const string& path) {
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        cerr << "Error: socket path too long\n";
+        return 1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str());
+    if (listen_fd < 0 || ::bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 64) < 0) {
+        cerr << "Error: cannot listen on " << path << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+    cerr << "Listening on " << path << "\n";
+
+    // One detached reader thread per client; only the live ones are counted,
+    // so a long-running server does not accumulate finished threads
+    mutex readers_mutex;
+    condition_variable readers_done;
+    int live_readers = 0;
+    vector<weak_ptr<Connection>> connections;
+    while (!stop_requested.load()) {
+        pollfd pfd = {listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) continue;
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) continue;
+        auto conn = make_shared<Connection>(fd, fd, true);
+        connections.erase(remove_if(connections.begin(), connections.end(),
+                                    [](const weak_ptr<Connection>& c) { return c.expired(); }),
+                          connections.end());
+        connections.push_back(conn);
+        {
+            lock_guard<mutex> lock(readers_mutex);
+            live_readers++;
+        }
+        thread([&, conn]() mutable {
+            server.serve(conn);
+            conn.reset();
+            // Notify under the lock: serve_socket may return as soon as it is released
+            lock_guard<mutex> lock(readers_mutex);
+            live_readers--;
+            readers_done.notify_all();
+        }).detach();
+    }
+
+    close(listen_fd);
+    unlink(path.c_str());
+    for (auto& weak : connections) {
+        if (auto conn = weak.lock()) conn->interrupt();
+    }
+    unique_lock<mutex> lock(readers_mutex);
+    readers_done.wait(lock, [&] { return live_readers == 0; });
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    bench::Options opt(argc, argv);
+    opt.check_known({"graph", "vertices", "density", "min-weight", "max-weight", "seed",
+                     "socket", "threads", "batch", "batch-delay-us", "help"});
+    if (opt.has("help")) {
+        cout << "Usage: graph_server [options]\n"
+             << "  --graph=PATH          edge list 'src dest [weight]' (default: random graph)\n"
+             << "  --vertices=N          random graph vertices (default 100000)\n"
+             << "  --density=N           random graph edges per vertex (default 8)\n"
+             << "  --min-weight=W        smallest edge weight (default 1)\n"
+             << "  --max-weight=W        largest edge weight (default 100)\n"
+             << "  --seed=S              random graph seed (default 1)\n"
+             << "  --socket=PATH         serve a Unix domain socket (default: stdin/stdout)\n"
+             << "  --threads=N           worker threads (default: all)\n"
+             << "  --batch=N             largest batch (default 64)\n"
+             << "  --batch-delay-us=T    time to wait for a batch to fill (default 200)\n"
+             << "\nRequests, one per line; responses are '<id> OK <result>' or '<id> ERR <message>'\n"
+             << "and may arrive out of order:\n"
+             << "  <id> BFS <src>            vertices per BFS level\n"
+             << "  <id> REACH <src> <dest>   1 if dest is reachable from src, else 0\n"
+             << "  <id> SSSP <src>           reached vertices, largest and summed distance\n"
+             << "  <id> DIST <src> <dest>    shortest path length or INF\n"
+             << "  <id> STATS                graph size, batching and latency percentiles\n"
+             << "  QUIT                      close the connection\n";
+        return 0;
+    }
+
+    const int vertices = (int)opt.get_int("vertices", 100000);
+    const int edge_density = (int)opt.get_int("density", 8);
+    const int min_weight = (int)opt.get_int("min-weight", 1);
+    const int max_weight = (int)opt.get_int("max-weight", 100);
+    const unsigned seed = (unsigned)opt.get_int("seed", 1);
+    const int threads = (int)opt.get_int("threads", 0);
+    const int max_batch = (int)opt.get_int("batch", 64);
+    const int batch_delay_us = (int)opt.get_int("batch-delay-us", 200);
+    if (vertices <= 1 || edge_density <= 0) opt.error("--vertices must be > 1 and --density > 0");
+    if (min_weight < 0 || max_weight < min_weight) opt.error("need 0 <= --min-weight <= --max-weight");
+    if (max_batch <= 0 || batch_delay_us < 0) opt.error("--batch must be > 0 and --batch-delay-us >= 0");
+    if (opt.report_errors()) return 1;
+
+    // Load the graph once
+    auto start = steady_clock::now();
+    CSRGraph graph;
+    if (opt.has("graph")) {
+        string error;
+        if (!load_graph(opt.get_string("graph", ""), graph, error)) {
+            cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        if (graph.V == 0) {
+            cerr << "Error: graph has no vertices\n";
+            return 1;
+        }
+    } else {
+        graph = generate_graph(vertices, edge_density, min_weight, max_weight, seed);
+    }
+    cerr << "Graph: " << graph.V << " vertices, " << graph.num_edges() << " edges, ready in "
+         << duration_cast<milliseconds>(steady_clock::now() - start).count() << " ms\n";
+
+    // No SA_RESTART: a blocking read on stdin must return EINTR so the
+    // server notices the stop request
+    signal(SIGPIPE, SIG_IGN);
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    // Pool and batcher threads inherit a blocked mask, so the signal
+    // interrupts the main thread's read rather than landing on a worker
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+    QueryServer server(graph, threads, max_batch, batch_delay_us);
+    pthread_sigmask(SIG_UNBLOCK, &stop_signals, nullptr);
+    int rc = 0;
+    if (opt.has("socket")) {
+        rc = serve_socket(server, opt.get_string("socket", ""));
+    } else {
+        server.serve(make_shared<Connection>(STDIN_FILENO, STDOUT_FILENO, false));
+    }
+    server.shutdown();
+
+    cerr << "Stats: " << server.stats() << "\n";
+    cerr << "Latency histogram: " << server.latency().buckets() << "\n";
+    return rc;
+}
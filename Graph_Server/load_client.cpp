@@ -0,0 +1,219 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../Benchmark/bench.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// Blocking line-oriented client for the graph server's Unix socket
+class Client {
+public:
+    bool connect_to(const string& path, string& error) {
+        fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        if (fd_ < 0 || ::connect(fd_, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            error = "cannot connect to " + path + ": " + strerror(errno);
+            return false;
+        }
+        return true;
+    }
+
+    ~Client() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool send_line(const string& line) {
+        string data = line + "\n";
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t n = ::send(fd_, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+
+    bool read_line(string& line) {
+        while (true) {
+            size_t nl = buffer_.find('\n');
+            if (nl != string::npos) {
+                line = buffer_.substr(0, nl);
+                buffer_.erase(0, nl + 1);
+                return true;
+            }
+            char chunk[4096];
+            ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buffer_.append(chunk, n);
+        }
+    }
+
+private:
+    int fd_ = -1;
+    string buffer_;
+};
+
+// Value of "key=" in a STATS response, or -1
+long long stat_value(const string& response, const string& key) {
+    size_t pos = response.find(" " + key + "=");
+    if (pos == string::npos) return -1;
+    return atoll(response.c_str() + pos + key.size() + 2);
+}
+
+double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t i = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[min(i, sorted.size() - 1)];
+}
+
+int main(int argc, char* argv[]) {
+    bench::Options opt(argc, argv);
+    opt.check_known({"socket", "clients", "requests", "window", "kinds", "sources", "seed", "help"});
+    if (opt.has("help") || !opt.has("socket")) {
+        cout << "Usage: load_client --socket=PATH [options]\n"
+             << "  --clients=N      concurrent connections (default 4)\n"
+             << "  --requests=N     requests per connection (default 1000)\n"
+             << "  --window=N       requests in flight per connection (default 8)\n"
+             << "  --kinds=LIST     query mix, e.g. DIST,REACH,BFS,SSSP (default DIST,REACH)\n"
+             << "  --sources=N      draw sources from the first N vertices, so that\n"
+             << "                   concurrent queries can share traversals (default: all)\n"
+             << "  --seed=S         random seed (default 1)\n";
+        return opt.has("help") ? 0 : 1;
+    }
+
+    const string path = opt.get_string("socket", "");
+    const int clients = (int)opt.get_int("clients", 4);
+    const int requests = (int)opt.get_int("requests", 1000);
+    const int window = (int)opt.get_int("window", 8);
+    const unsigned seed = (unsigned)opt.get_int("seed", 1);
+    vector<string> kinds;
+    {
+        stringstream ss(opt.get_string("kinds", "DIST,REACH"));
+        string kind;
+        while (getline(ss, kind, ',')) {
+            for (char& c : kind) c = (char)toupper((unsigned char)c);
+            if (kind == "BFS" || kind == "SSSP" || kind == "DIST" || kind == "REACH") kinds.push_back(kind);
+            else if (!kind.empty()) opt.error("unknown query kind " + kind);
+        }
+    }
+    if (clients <= 0 || requests <= 0 || window <= 0) opt.error("--clients, --requests and --window must be > 0");
+    if (kinds.empty()) opt.error("--kinds is empty");
+    if (opt.has("sources") && opt.get_int("sources", 1) <= 0) opt.error("--sources must be > 0");
+    if (opt.report_errors()) return 1;
+
+    // Ask the server for the graph size
+    long long vertices;
+    {
+        Client probe;
+        string error, response;
+        if (!probe.connect_to(path, error)) {
+            cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        if (!probe.send_line("0 STATS") || !probe.read_line(response) || (vertices = stat_value(response, "vertices")) <= 0) {
+            cerr << "Error: unexpected STATS response '" << response << "'\n";
+            return 1;
+        }
+    }
+    const long long sources = min(vertices, opt.get_int("sources", vertices));
+
+    cout << "Load: " << clients << " clients x " << requests << " requests, window " << window
+         << ", graph of " << vertices << " vertices\n";
+
+    vector<double> latencies; // microseconds, all clients
+    mutex latencies_mutex;
+    atomic<long long> errors(0), failed_clients(0);
+
+    auto start = steady_clock::now();
+    vector<thread> threads;
+    for (int c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            Client client;
+            string error;
+            if (!client.connect_to(path, error)) {
+                failed_clients++;
+                return;
+            }
+            mt19937 gen(seed + c);
+            uniform_int_distribution<long long> src_dist(0, sources - 1);
+            uniform_int_distribution<long long> dest_dist(0, vertices - 1);
+            uniform_int_distribution<int> kind_dist(0, (int)kinds.size() - 1);
+
+            vector<steady_clock::time_point> sent(requests);
+            vector<double> local;
+            local.reserve(requests);
+            int next = 0, received = 0;
+
+            auto send_next = [&] {
+                const string& kind = kinds[kind_dist(gen)];
+                ostringstream line;
+                line << next << " " << kind << " " << src_dist(gen);
+                if (kind == "DIST" || kind == "REACH") line << " " << dest_dist(gen);
+                sent[next] = steady_clock::now();
+                ++next;
+                return client.send_line(line.str());
+            };
+
+            // Keep `window` requests outstanding; responses may come back in any order
+            while (next < requests && next < window) {
+                if (!send_next()) break;
+            }
+            string response;
+            while (received < next && client.read_line(response)) {
+                auto now = steady_clock::now();
+                int id = atoi(response.c_str());
+                if (id < 0 || id >= next) {
+                    errors++;
+                    break;
+                }
+                if (response.find(" OK ") == string::npos) errors++;
+                local.push_back(duration<double, micro>(now - sent[id]).count());
+                ++received;
+                if (next < requests && !send_next()) break;
+            }
+            if (received < requests) errors += requests - received;
+            client.send_line("QUIT");
+
+            lock_guard<mutex> lock(latencies_mutex);
+            latencies.insert(latencies.end(), local.begin(), local.end());
+        });
+    }
+    for (auto& t : threads) t.join();
+    double seconds = duration<double>(steady_clock::now() - start).count();
+
+    if (failed_clients > 0) cerr << "Warning: " << failed_clients << " clients could not connect\n";
+    sort(latencies.begin(), latencies.end());
+    cout << fixed << setprecision(1);
+    cout << "Completed: " << latencies.size() << " responses in " << seconds << " s, "
+         << (errors > 0 ? to_string(errors.load()) + " errors" : "no errors") << "\n";
+    cout << "Throughput: " << latencies.size() / seconds << " requests/s\n";
+    cout << "Latency (us): p50 " << percentile(latencies, 50) << ", p95 " << percentile(latencies, 95)
+         << ", p99 " << percentile(latencies, 99) << ", max " << (latencies.empty() ? 0.0 : latencies.back()) << "\n";
+
+    // Server-side view: batching and queueing latency
+    Client probe;
+    string error, response;
+    if (probe.connect_to(path, error) && probe.send_line("0 STATS") && probe.read_line(response)) {
+        cout << "Server: " << response.substr(min(response.size(), (size_t)5)) << "\n";
+    }
+    return errors > 0 || failed_clients > 0 ? 1 : 0;
+}
@@ -0,0 +1,340 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+// Reusable histogram / binning API used by the histogram sort.
+//
+// Each thread counts into SUB_HISTOGRAMS interleaved sub-histograms
+// (element i goes to sub-histogram i % SUB_HISTOGRAMS), so runs of equal
+// values increment different memory locations instead of stalling on
+// store-to-load forwarding of the same counter. Bin indices are computed
+// a block at a time with AVX-512 / AVX2 when the compiler targets them
+// (e.g. -march=native) and with plain scalar code otherwise. Per-thread
+// results are combined with a parallel reduction over the bins.
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace hist {
+
+// Number of interleaved sub-histograms per thread
+constexpr int SUB_HISTOGRAMS = 4;
+
+// Number of elements whose bin indices are computed in one go
+constexpr size_t BLOCK = 256;
+
+// Custom/log bins up to this count use a vectorised linear edge scan,
+// larger ones fall back to binary search
+constexpr int LINEAR_EDGE_LIMIT = 64;
+
+// Name of the instruction set used for bin-index computation
+inline const char* simd_name() {
+#if defined(__AVX512F__)
+    return "AVX-512";
+#elif defined(__AVX2__)
+    return "AVX2";
+#else
+    return "scalar";
+#endif
+}
+
+// Bin indices for integers: one bin per value in [min_val, min_val + bins).
+// Out-of-range values get index `bins`, the discard slot.
+inline void int_bin_indices(const int* data, size_t n, int min_val, int bins, int32_t* out) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512i vmin = _mm512_set1_epi32(min_val);
+    const __m512i vbins = _mm512_set1_epi32(bins);
+    for (; i + 16 <= n; i += 16) {
+        __m512i b = _mm512_sub_epi32(_mm512_loadu_si512(data + i), vmin);
+        __mmask16 ok = _mm512_cmplt_epu32_mask(b, vbins);
+        _mm512_storeu_si512(out + i, _mm512_mask_blend_epi32(ok, vbins, b));
+    }
+#elif defined(__AVX2__)
+    const __m256i vmin = _mm256_set1_epi32(min_val);
+    const __m256i vbins = _mm256_set1_epi32(bins);
+    const __m256i vlast = _mm256_set1_epi32(bins - 1);
+    for (; i + 8 <= n; i += 8) {
+        __m256i b = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(data + i)), vmin);
+        // Unsigned b < bins  <=>  min_epu32(b, bins - 1) == b
+        __m256i ok = _mm256_cmpeq_epi32(_mm256_min_epu32(b, vlast), b);
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_blendv_epi8(vbins, b, ok));
+    }
+#endif
+    for (; i < n; ++i) {
+        uint32_t b = (uint32_t)data[i] - (uint32_t)min_val;
+        out[i] = b < (uint32_t)bins ? (int32_t)b : bins;
+    }
+}
+
+// Bin layout for floating point samples. Bins are half-open [e_k, e_k+1);
+// samples outside [lo, hi) and NaNs are ignored. Float samples are binned
+// against float-rounded edges with the SIMD paths below; double samples
+// against the exact edges, one sample at a time.
+class Binning {
+public:
+    // `bins` equal-width bins covering [lo, hi)
+    static Binning fixed_width(double lo, double hi, int bins) {
+        if (bins <= 0 || !(lo < hi)) throw std::invalid_argument("fixed_width: need bins > 0 and lo < hi");
+        Binning b;
+        b.kind_ = FIXED;
+        b.bins_ = bins;
+        b.lo_ = (float)lo;
+        b.hi_ = (float)hi;
+        b.inv_width_ = (float)(bins / (hi - lo));
+        b.dlo_ = lo;
+        b.dhi_ = hi;
+        b.dinv_width_ = bins / (hi - lo);
+        return b;
+    }
+
+    // `bins` geometrically spaced bins covering [lo, hi), lo > 0.
+    // Stored as explicit edges so the same edge scan handles them.
+    static Binning log_scale(double lo, double hi, int bins) {
+        if (bins <= 0 || !(lo > 0) || !(lo < hi)) throw std::invalid_argument("log_scale: need bins > 0 and 0 < lo < hi");
+        std::vector<double> edges(bins + 1);
+        const double ratio = std::log(hi / lo);
+        for (int k = 0; k <= bins; ++k) {
+            edges[k] = lo * std::exp(ratio * k / bins);
+        }
+        edges[0] = lo;
+        edges[bins] = hi;
+        return custom(edges);
+    }
+
+    // Arbitrary strictly ascending edges; edges.size() - 1 bins
+    static Binning custom(const std::vector<double>& edges) {
+        if (edges.size() < 2) throw std::invalid_argument("custom: need at least two edges");
+        Binning b;
+        b.kind_ = EDGES;
+        b.bins_ = (int)edges.size() - 1;
+        for (double e : edges) b.edges_.push_back((float)e);
+        // Strict in float implies strict in double
+        for (size_t k = 1; k < b.edges_.size(); ++k) {
+            if (!(b.edges_[k - 1] < b.edges_[k])) throw std::invalid_argument("custom: edges must be strictly ascending");
+        }
+        b.lo_ = b.edges_.front();
+        b.hi_ = b.edges_.back();
+        b.dedges_ = edges;
+        b.dlo_ = edges.front();
+        b.dhi_ = edges.back();
+        return b;
+    }
+
+    int bins() const { return bins_; }
+
+    // Bin of a single sample, or bins() when it is out of range
+    int bin_index(float x) const { return index_of(x, lo_, hi_, inv_width_, edges_); }
+    int bin_index(double x) const { return index_of(x, dlo_, dhi_, dinv_width_, dedges_); }
+
+    // Bin indices of n samples; out-of-range samples get bins()
+    void bin_indices(const float* x, size_t n, int32_t* out) const {
+        if (kind_ == FIXED) fixed_indices(x, n, out);
+        else if (bins_ <= LINEAR_EDGE_LIMIT) edge_scan_indices(x, n, out);
+        else for (size_t i = 0; i < n; ++i) out[i] = bin_index(x[i]);
+    }
+    void bin_indices(const double* x, size_t n, int32_t* out) const {
+        for (size_t i = 0; i < n; ++i) out[i] = bin_index(x[i]);
+    }
+
+private:
+    enum Kind { FIXED, EDGES };
+
+    Kind kind_ = FIXED;
+    int bins_ = 0;
+    float lo_ = 0, hi_ = 0;
+    float inv_width_ = 0;
+    std::vector<float> edges_;
+    // The same layout without rounding, for double samples
+    double dlo_ = 0, dhi_ = 0;
+    double dinv_width_ = 0;
+    std::vector<double> dedges_;
+
+    template <typename T>
+    int index_of(T x, T lo, T hi, T inv_width, const std::vector<T>& edges) const {
+        if (!(x >= lo && x < hi)) return bins_;
+        if (kind_ == FIXED) {
+            int b = (int)((x - lo) * inv_width);
+            return b < bins_ - 1 ? b : bins_ - 1;
+        }
+        // Number of interior edges <= x
+        return (int)(std::upper_bound(edges.begin() + 1, edges.end() - 1, x) - (edges.begin() + 1));
+    }
+
+    void fixed_indices(const float* x, size_t n, int32_t* out) const {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        const __m512 vlo = _mm512_set1_ps(lo_), vhi = _mm512_set1_ps(hi_), vinv = _mm512_set1_ps(inv_width_);
+        const __m512i vbins = _mm512_set1_epi32(bins_), vlast = _mm512_set1_epi32(bins_ - 1);
+        for (; i + 16 <= n; i += 16) {
+            __m512 v = _mm512_loadu_ps(x + i);
+            __mmask16 ok = _mm512_cmp_ps_mask(v, vlo, _CMP_GE_OQ) & _mm512_cmp_ps_mask(v, vhi, _CMP_LT_OQ);
+            __m512i b = _mm512_cvttps_epi32(_mm512_mul_ps(_mm512_sub_ps(v, vlo), vinv));
+            b = _mm512_min_epi32(b, vlast);
+            _mm512_storeu_si512(out + i, _mm512_mask_blend_epi32(ok, vbins, b));
+        }
+#elif defined(__AVX2__)
+        const __m256 vlo = _mm256_set1_ps(lo_), vhi = _mm256_set1_ps(hi_), vinv = _mm256_set1_ps(inv_width_);
+        const __m256i vbins = _mm256_set1_epi32(bins_), vlast = _mm256_set1_epi32(bins_ - 1);
+        for (; i + 8 <= n; i += 8) {
+            __m256 v = _mm256_loadu_ps(x + i);
+            __m256 ok = _mm256_and_ps(_mm256_cmp_ps(v, vlo, _CMP_GE_OQ), _mm256_cmp_ps(v, vhi, _CMP_LT_OQ));
+            __m256i b = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(v, vlo), vinv));
+            b = _mm256_min_epi32(b, vlast);
+            _mm256_storeu_si256((__m256i*)(out + i), _mm256_blendv_epi8(vbins, b, _mm256_castps_si256(ok)));
+        }
+#endif
+        for (; i < n; ++i) out[i] = bin_index(x[i]);
+    }
+
+    // Vectorised across samples: index = number of interior edges <= x
+    void edge_scan_indices(const float* x, size_t n, int32_t* out) const {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        const __m512 vlo = _mm512_set1_ps(lo_), vhi = _mm512_set1_ps(hi_);
+        const __m512i vbins = _mm512_set1_epi32(bins_), one = _mm512_set1_epi32(1);
+        for (; i + 16 <= n; i += 16) {
+            __m512 v = _mm512_loadu_ps(x + i);
+            __mmask16 ok = _mm512_cmp_ps_mask(v, vlo, _CMP_GE_OQ) & _mm512_cmp_ps_mask(v, vhi, _CMP_LT_OQ);
+            __m512i b = _mm512_setzero_si512();
+            for (int k = 1; k < bins_; ++k) {
+                __mmask16 ge = _mm512_cmp_ps_mask(v, _mm512_set1_ps(edges_[k]), _CMP_GE_OQ);
+                b = _mm512_mask_add_epi32(b, ge, b, one);
+            }
+            _mm512_storeu_si512(out + i, _mm512_mask_blend_epi32(ok, vbins, b));
+        }
+#elif defined(__AVX2__)
+        const __m256 vlo = _mm256_set1_ps(lo_), vhi = _mm256_set1_ps(hi_);
+        const __m256i vbins = _mm256_set1_epi32(bins_);
+        for (; i + 8 <= n; i += 8) {
+            __m256 v = _mm256_loadu_ps(x + i);
+            __m256 ok = _mm256_and_ps(_mm256_cmp_ps(v, vlo, _CMP_GE_OQ), _mm256_cmp_ps(v, vhi, _CMP_LT_OQ));
+            __m256i b = _mm256_setzero_si256();
+            for (int k = 1; k < bins_; ++k) {
+                // Comparison mask is -1 where x >= edge, so subtracting counts it
+                __m256 ge = _mm256_cmp_ps(v, _mm256_set1_ps(edges_[k]), _CMP_GE_OQ);
+                b = _mm256_sub_epi32(b, _mm256_castps_si256(ge));
+            }
+            _mm256_storeu_si256((__m256i*)(out + i), _mm256_blendv_epi8(vbins, b, _mm256_castps_si256(ok)));
+        }
+#endif
+        for (; i < n; ++i) out[i] = bin_index(x[i]);
+    }
+};
+
+// Sequential counting of n elements into counts[0..bins).
+// `indices(first, len, out)` writes the bin index of each element, with
+// `bins` marking elements to discard. counts is accumulated, not cleared.
+template <typename T, typename IndexFn>
+void count_with(const T* data, size_t n, int bins, IndexFn indices, uint64_t* counts) {
+    // SUB_HISTOGRAMS rows of bins + 1 counters, the extra one is the discard slot
+    const size_t stride = (size_t)bins + 1;
+    std::vector<uint64_t> sub(SUB_HISTOGRAMS * stride, 0);
+    uint64_t* c0 = sub.data();
+    uint64_t* c1 = c0 + stride;
+    uint64_t* c2 = c1 + stride;
+    uint64_t* c3 = c2 + stride;
+    static_assert(SUB_HISTOGRAMS == 4, "unrolled loop below assumes four sub-histograms");
+
+    int32_t idx[BLOCK];
+    for (size_t base = 0; base < n; base += BLOCK) {
+        const size_t len = std::min(BLOCK, n - base);
+        indices(data + base, len, idx);
+
+        size_t i = 0;
+        for (; i + 4 <= len; i += 4) {
+            c0[idx[i]]++;
+            c1[idx[i + 1]]++;
+            c2[idx[i + 2]]++;
+            c3[idx[i + 3]]++;
+        }
+        for (; i < len; ++i) c0[idx[i]]++;
+    }
+
+    for (int b = 0; b < bins; ++b) {
+        counts[b] += c0[b] + c1[b] + c2[b] + c3[b];
+    }
+}
+
+// Sequential integer histogram of n values, one bin per value starting at min_val
+inline void count(const int* data, size_t n, int min_val, int bins, uint64_t* counts) {
+    count_with(data, n, bins, [=](const int* first, size_t len, int32_t* out) {
+        int_bin_indices(first, len, min_val, bins, out);
+    }, counts);
+}
+
+// Sequential float / double histogram of n samples
+inline void count(const float* data, size_t n, const Binning& binning, uint64_t* counts) {
+    count_with(data, n, binning.bins(), [&](const float* first, size_t len, int32_t* out) {
+        binning.bin_indices(first, len, out);
+    }, counts);
+}
+inline void count(const double* data, size_t n, const Binning& binning, uint64_t* counts) {
+    count_with(data, n, binning.bins(), [&](const double* first, size_t len, int32_t* out) {
+        binning.bin_indices(first, len, out);
+    }, counts);
+}
+
+// Parallel histogram: every thread counts a contiguous chunk into its own
+// row, then the rows are summed bin-parallel.
+template <typename T, typename CountFn>
+std::vector<uint64_t> parallel_histogram(const T* data, size_t n, int bins, CountFn count_chunk) {
+    std::vector<uint64_t> result(bins, 0);
+    std::vector<std::vector<uint64_t>> local(omp_get_max_threads());
+
+    #pragma omp parallel
+    {
+        const int t = omp_get_thread_num();
+        const int nt = omp_get_num_threads();
+        const size_t begin = n * t / nt;
+        const size_t end = n * (t + 1) / nt;
+
+        local[t].assign(bins, 0);
+        count_chunk(data + begin, end - begin, local[t].data());
+
+        #pragma omp barrier
+
+        // Parallel reduction over bins
+        #pragma omp for
+        for (int b = 0; b < bins; ++b) {
+            uint64_t sum = 0;
+            for (int r = 0; r < nt; ++r) sum += local[r][b];
+            result[b] = sum;
+        }
+    }
+    return result;
+}
+
+// Histogram of integers in [min_val, max_val], one bin per value.
+// Values outside the range are ignored.
+inline std::vector<uint64_t> histogram(const std::vector<int>& data, int min_val, int max_val) {
+    if (max_val < min_val) throw std::invalid_argument("histogram: max_val < min_val");
+    const int bins = max_val - min_val + 1;
+    return parallel_histogram(data.data(), data.size(), bins, [=](const int* first, size_t len, uint64_t* counts) {
+        count(first, len, min_val, bins, counts);
+    });
+}
+
+// Histogram of float or double samples using fixed-width, log-scale or custom bins
+inline std::vector<uint64_t> histogram(const std::vector<float>& data, const Binning& binning) {
+    return parallel_histogram(data.data(), data.size(), binning.bins(), [&](const float* first, size_t len, uint64_t* counts) {
+        count(first, len, binning, counts);
+    });
+}
+inline std::vector<uint64_t> histogram(const std::vector<double>& data, const Binning& binning) {
+    return parallel_histogram(data.data(), data.size(), binning.bins(), [&](const double* first, size_t len, uint64_t* counts) {
+        count(first, len, binning, counts);
+    });
+}
+
+} // namespace hist
+
+#endif // HISTOGRAM_H
@@ -5,6 +5,12 @@
 #include <iomanip>
 #include <omp.h>
 #include <chrono>
+#include <cmath>
+#include <limits>
+#include "histogram.h"
+#include "../Tracing/trace.h"
+#include "../Perf_Counters/perf_counters.h"
+#include "../Benchmark/bench.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -26,13 +32,11 @@ vector<int> generate_data(size_t size, int min_val, int max_val) {
 // Sequential histogram sort
 vector<int> histogram_sort_seq(const vector<int>& input, int min_val, int max_val) {
     const int range = max_val - min_val + 1;
-    vector<int> histogram(range, 0);
+    vector<uint64_t> histogram(range, 0);
     vector<int> output(input.size());
 
     // Build histogram
-    for (int num : input) {
-        histogram[num - min_val]++;
-    }
+    hist::count(input.data(), input.size(), min_val, range, histogram.data());
 
     // Calculate cumulative sum
     for (int i = 1; i < range; ++i) {
@@ -40,38 +44,102 @@ vector<int> histogram_sort_seq(const vector<int>& input, int min_val, int max_va
     }
 
     // Place elements in sorted order
-    for (int i = input.size() - 1; i >= 0; --i) {
+    for (size_t i = input.size(); i-- > 0; ) {
         output[--histogram[input[i] - min_val]] = input[i];
     }
 
     return output;
 }
 
-// Parallel histogram sort
-vector<int> histogram_sort_par(const vector<int>& input, int min_val, int max_val) {
+// Per-thread counting needs, for every thread and value, one offset plus
+// hist::SUB_HISTOGRAMS counters (~40 bytes). Above this total the parallel
+// sort falls back to one shared, atomically updated histogram. A single
+// thread needs no more than the sequential sort and never falls back.
+const size_t PER_THREAD_TABLE_LIMIT = 64u << 20;
+
+// Parallel histogram sort with a single shared histogram: range counters
+// whatever the thread count, at the price of an atomic per element
+vector<int> histogram_sort_shared(const vector<int>& input, int min_val, int max_val) {
+    TRACE_ZONE("histogram_sort_shared");
     const int range = max_val - min_val + 1;
-    vector<int> histogram(range, 0);
-    vector<int> output(input.size());
+    const size_t n = input.size();
+    vector<uint64_t> histogram(range, 0);
+    vector<int> output(n);
 
-    // Parallel histogram construction
     #pragma omp parallel for
-    for (int i = 0; i < input.size(); ++i) {
+    for (size_t i = 0; i < n; ++i) {
         #pragma omp atomic
         histogram[input[i] - min_val]++;
     }
 
-    // Sequential prefix sum
-    for (int i = 1; i < range; ++i) {
-        histogram[i] += histogram[i - 1];
+    // Exclusive prefix sum: histogram[b] becomes the first slot of value b
+    uint64_t sum = 0;
+    for (int b = 0; b < range; ++b) {
+        uint64_t c = histogram[b];
+        histogram[b] = sum;
+        sum += c;
     }
 
-    // Parallel placement
+    // Equal values are interchangeable, so the order they land in does not matter
     #pragma omp parallel for
-    for (int i = input.size() - 1; i >= 0; --i) {
-        int pos;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t pos;
         #pragma omp atomic capture
-        { pos = histogram[input[i] - min_val]; histogram[input[i] - min_val]--; }
-        output[pos - 1] = input[i];
+        pos = histogram[input[i] - min_val]++;
+        output[pos] = input[i];
+    }
+
+    return output;
+}
+
+// Parallel histogram sort
+vector<int> histogram_sort_par(const vector<int>& input, int min_val, int max_val) {
+    const int range = max_val - min_val + 1;
+    const size_t table_bytes = (size_t)omp_get_max_threads() * range * (1 + hist::SUB_HISTOGRAMS) * sizeof(uint64_t);
+    if (omp_get_max_threads() > 1 && table_bytes > PER_THREAD_TABLE_LIMIT) return histogram_sort_shared(input, min_val, max_val);
+
+    TRACE_ZONE("histogram_sort_par");
+    const size_t n = input.size();
+    vector<int> output(n);
+
+    // offsets[t * range + b]: next output slot for value b in thread t's chunk
+    vector<uint64_t> offsets((size_t)omp_get_max_threads() * range, 0);
+
+    #pragma omp parallel
+    {
+        const int t = omp_get_thread_num();
+        const int nt = omp_get_num_threads();
+        const size_t begin = n * t / nt;
+        const size_t end = n * (t + 1) / nt;
+        uint64_t* local = &offsets[(size_t)t * range];
+
+        // Per-thread histogram of this thread's chunk
+        {
+            TRACE_ZONE("histogram");
+            hist::count(input.data() + begin, end - begin, min_val, range, local);
+        }
+
+        #pragma omp barrier
+
+        // Exclusive prefix sum in (value, thread) order keeps the sort stable
+        #pragma omp single
+        {
+            TRACE_ZONE("prefix_sum");
+            uint64_t sum = 0;
+            for (int b = 0; b < range; ++b) {
+                for (int r = 0; r < nt; ++r) {
+                    uint64_t c = offsets[(size_t)r * range + b];
+                    offsets[(size_t)r * range + b] = sum;
+                    sum += c;
+                }
+            }
+        }
+
+        // Each thread places its own chunk without atomics
+        TRACE_ZONE("placement");
+        for (size_t i = begin; i < end; ++i) {
+            output[local[input[i] - min_val]++] = input[i];
+        }
     }
 
     return output;
@@ -85,7 +153,110 @@ bool is_sorted(const vector<int>& data) {
     return true;
 }
 
-int main() {
+// Checks the float and double binning API against a scalar reference:
+// every Binning kind on random samples plus edges, range ends,
+// out-of-range values, infinities and NaN
+bool verify_binning() {
+    vector<float> samples;
+    mt19937 gen(7);
+    uniform_real_distribution<float> dist(-10.0f, 1100.0f);
+    for (int i = 0; i < 100000; ++i) samples.push_back(dist(gen));
+    const float special[] = {0.0f, 1000.0f, -0.0f, nextafterf(0.0f, -1.0f), nextafterf(1000.0f, 0.0f),
+                             1e-3f, 1.0f, 10.0f, 100.0f, -1e30f, 1e30f,
+                             numeric_limits<float>::infinity(), -numeric_limits<float>::infinity(),
+                             numeric_limits<float>::quiet_NaN()};
+    samples.insert(samples.end(), begin(special), end(special));
+    // Doubles that round to an edge in float but lie just below it
+    vector<double> dsamples(samples.begin(), samples.end());
+    dsamples.insert(dsamples.end(), {nextafter(1000.0, 0.0), nextafter(10.0, 0.0), 1e-3 * (1 - 1e-12)});
+
+    const hist::Binning binnings[] = {
+        hist::Binning::fixed_width(0.0, 1000.0, 64),
+        hist::Binning::log_scale(1e-3, 1e3, 60),
+        hist::Binning::log_scale(1e-3, 1e3, 200), // binary-search path
+        hist::Binning::custom({0, 1, 10, 100, 1000}),
+    };
+    bool ok = true;
+    for (const hist::Binning& b : binnings) {
+        // Scalar reference: bin_index one sample at a time
+        vector<uint64_t> expected(b.bins(), 0);
+        for (float x : samples) {
+            const int k = b.bin_index(x);
+            if (k < b.bins()) expected[k]++;
+        }
+        ok = ok && hist::histogram(samples, b) == expected;
+
+        vector<uint64_t> dexpected(b.bins(), 0);
+        for (double x : dsamples) {
+            const int k = b.bin_index(x);
+            if (k < b.bins()) dexpected[k]++;
+        }
+        ok = ok && hist::histogram(dsamples, b) == dexpected;
+    }
+
+    // Half-open bins: a range start or interior edge opens a bin, the range end is out
+    const hist::Binning fixed = binnings[0], custom = binnings[3];
+    ok = ok && fixed.bin_index(0.0f) == 0 && fixed.bin_index(1000.0f) == 64 &&
+         fixed.bin_index(nextafterf(1000.0f, 0.0f)) == 63 && fixed.bin_index(-1e-3f) == 64 &&
+         fixed.bin_index(numeric_limits<float>::quiet_NaN()) == 64;
+    ok = ok && custom.bin_index(0.0f) == 0 && custom.bin_index(1.0f) == 1 && custom.bin_index(10.0f) == 2 &&
+         custom.bin_index(100.0f) == 3 && custom.bin_index(1000.0f) == 4 &&
+         custom.bin_index(nextafterf(1.0f, 0.0f)) == 0;
+    // Doubles are binned against the exact edges
+    ok = ok && fixed.bin_index(nextafter(1000.0, 0.0)) == 63 && custom.bin_index(nextafter(10.0, 0.0)) == 1 &&
+         custom.bin_index(10.0) == 2 && fixed.bin_index(numeric_limits<double>::quiet_NaN()) == 64;
+    return ok;
+}
+
+// Non-interactive benchmark mode (see Benchmark/bench.h)
+int run_benchmark(const bench::Options& opt) {
+    auto known = bench::Suite::common_options();
+    known.insert({"min-value", "max-value"});
+    opt.check_known(known);
+    if (opt.has("help")) {
+        cout << "Usage: histogram_sort [options]   (no options: interactive)\n"
+             << "  --min-value=N     smallest value (default 0)\n"
+             << "  --max-value=N     largest value (default 1000)\n";
+        bench::Suite::print_common_help();
+        return 0;
+    }
+
+    bench::Suite suite("histogram_sort", opt, {10000000}, "elements");
+    const int min_val = (int)opt.get_int("min-value", 0);
+    const int max_val = (int)opt.get_int("max-value", 1000);
+    if (max_val < min_val) opt.error("--max-value must be >= --min-value");
+    if (opt.report_errors()) return 1;
+
+    if (!verify_binning()) {
+        cerr << "Error: float/double binning does not match the scalar reference\n";
+        return 1;
+    }
+
+    for (long long base : suite.sizes()) {
+        long long built = -1;
+        vector<int> data;
+        for (int threads : suite.threads()) {
+            const long long size = suite.size_for(base, threads);
+            if (size != built) {
+                data = generate_data(size, min_val, max_val);
+                vector<int> result;
+                bench::Stats stats = suite.measure([&] { result = histogram_sort_seq(data, min_val, max_val); });
+                suite.add("seq", base, size, 1, stats, is_sorted(result));
+                built = size;
+            }
+            omp_set_num_threads(threads);
+            vector<int> result;
+            bench::Stats stats = suite.measure([&] { result = histogram_sort_par(data, min_val, max_val); });
+            suite.add("par", base, size, threads, stats, is_sorted(result) && result.size() == data.size());
+        }
+    }
+    return suite.finish();
+}
+
+int main(int argc, char* argv[]) {
+    bench::Options opt(argc, argv);
+    if (!opt.interactive()) return run_benchmark(opt);
+
     // User configuration
     size_t data_size;
     int num_threads;
@@ -118,24 +289,33 @@ int main() {
     cout << "\nGenerating " << data_size << " random numbers (" 
          << min_val << " to " << max_val << ")...\n";
     auto data = generate_data(data_size, min_val, max_val);
+    cout << "Bin-index computation: " << hist::simd_name() << "\n";
+    cout << "Float/double binning check: " << (verify_binning() ? "Yes" : "No") << "\n";
     vector<int> seq_result, par_result;
+    perf::Session counters;
 
     // Sequential sort
     cout << "\nSequential histogram sort...\n";
+    counters.start(1);
     auto start_seq = high_resolution_clock::now();
     seq_result = histogram_sort_seq(data, min_val, max_val);
     auto end_seq = high_resolution_clock::now();
+    auto seq_counters = counters.stop();
     auto seq_time = duration_cast<milliseconds>(end_seq - start_seq).count();
     cout << "Time: " << seq_time << " ms\n";
+    perf::print(cout, seq_counters, "element", data_size);
     cout << "Verified: " << (is_sorted(seq_result) ? "Yes" : "No") << "\n";
 
     // Parallel sort
     cout << "\nParallel histogram sort (" << num_threads << " threads)...\n";
+    counters.start();
     auto start_par = high_resolution_clock::now();
     par_result = histogram_sort_par(data, min_val, max_val);
     auto end_par = high_resolution_clock::now();
+    auto par_counters = counters.stop();
     auto par_time = duration_cast<milliseconds>(end_par - start_par).count();
     cout << "Time: " << par_time << " ms\n";
+    perf::print(cout, par_counters, "element", data_size);
     cout << "Verified: " << (is_sorted(par_result) ? "Yes" : "No") << "\n";
 
     // Performance comparison
@@ -147,5 +327,9 @@ int main() {
         cout << "Speedup: Too fast to measure (parallel time < 1ms)\n";
     }
 
+#ifdef PARALLEL_TRACE
+    if (trace::write_chrome_json("histogram_sort_trace.json")) cout << "\nTrace written to histogram_sort_trace.json\n";
+#endif
+
     return 0;
 }
\ No newline at end of file
@@ -4,6 +4,11 @@
 #include <omp.h>
 #include <iomanip>  // For setprecision
 #include <cmath>    // For isfinite
+#include <algorithm>
+#include "../Task_Graph/task_graph.h"
+#include "../Tracing/trace.h"
+#include "../Perf_Counters/perf_counters.h"
+#include "../Benchmark/bench.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -47,18 +52,107 @@ void parallelMultiply(const vector<vector<int>>& A,
                      const vector<vector<int>>& B,
                      vector<vector<int>>& C, 
                      int m, int n, int p) {
-    #pragma omp parallel for
-    for (int i = 0; i < m; ++i) {
-        for (int j = 0; j < p; ++j) {
-            C[i][j] = 0;
-            for (int k = 0; k < n; ++k) {
-                C[i][j] += A[i][k] * B[k][j];
+    TRACE_ZONE("parallelMultiply");
+    #pragma omp parallel
+    {
+        // One zone per thread covering its static block of rows
+        TRACE_ZONE("row_block");
+        #pragma omp for schedule(static) nowait
+        for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < p; ++j) {
+                C[i][j] = 0;
+                for (int k = 0; k < n; ++k) {
+                    C[i][j] += A[i][k] * B[k][j];
+                }
+            }
+        }
+    }
+}
+
+// Tiled multiplication as a task graph. Task (i, j, k) computes
+// C(i,j) += A(i,k) * B(k,j); tasks on the same C tile are chained through
+// their inout dependency, everything else can overlap. A and B are only
+// read, so they need no dependencies. The graph is built once and every
+// graph.run() recomputes C from the current A and B; the matrices must
+// not be resized while the graph is in use.
+const int TILE = 64;
+
+void buildTiledMultiplyGraph(tg::TaskGraph& graph,
+                             const vector<vector<int>>& A,
+                             const vector<vector<int>>& B,
+                             vector<vector<int>>& C,
+                             int m, int n, int p) {
+    graph.clear();
+    for (int i0 = 0; i0 < m; i0 += TILE) {
+        for (int j0 = 0; j0 < p; j0 += TILE) {
+            const int i1 = min(i0 + TILE, m), j1 = min(j0 + TILE, p);
+            for (int k0 = 0; k0 < max(n, 1); k0 += TILE) {
+                const int k1 = min(k0 + TILE, n);
+                graph.add([&, i0, i1, j0, j1, k0, k1] {
+                    for (int i = i0; i < i1; ++i) {
+                        if (k0 == 0) fill(C[i].begin() + j0, C[i].begin() + j1, 0);
+                        for (int k = k0; k < k1; ++k) {
+                            const int a = A[i][k];
+                            for (int j = j0; j < j1; ++j) {
+                                C[i][j] += a * B[k][j];
+                            }
+                        }
+                    }
+                }, {tg::inout(&C[i0][j0])},
+                   (double)(i1 - i0) * (j1 - j0) * (k1 - k0));
+            }
+        }
+    }
+}
+
+// Non-interactive benchmark mode (see Benchmark/bench.h). Sizes are the
+// dimension n of square n x n matrices.
+int run_benchmark(const bench::Options& opt) {
+    opt.check_known(bench::Suite::common_options());
+    if (opt.has("help")) {
+        cout << "Usage: matrix_multiplication [options]   (no options: interactive)\n";
+        bench::Suite::print_common_help();
+        return 0;
+    }
+
+    bench::Suite suite("matrix_multiplication", opt, {512}, "n", "seq", 3.0); // n^3 work
+    if (opt.report_errors()) return 1;
+
+    srand(42);
+    for (long long base : suite.sizes()) {
+        long long built = -1;
+        vector<vector<int>> A, B, C_seq;
+        for (int threads : suite.threads()) {
+            const int n = (int)suite.size_for(base, threads);
+            if (n != built) {
+                A.assign(n, vector<int>(n));
+                B.assign(n, vector<int>(n));
+                C_seq.assign(n, vector<int>(n));
+                initializeMatrix(A, n, n);
+                initializeMatrix(B, n, n);
+                suite.add("seq", base, n, 1, suite.measure([&] { sequentialMultiply(A, B, C_seq, n, n, n); }), true);
+                built = n;
             }
+            omp_set_num_threads(threads);
+            vector<vector<int>> C(n, vector<int>(n));
+            bench::Stats stats = suite.measure([&] { parallelMultiply(A, B, C, n, n, n); });
+            suite.add("par", base, n, threads, stats, C == C_seq);
+
+            // Built outside the timed region and re-run by every repetition
+            vector<vector<int>> C_dag(n, vector<int>(n));
+            tg::TaskGraph graph;
+            buildTiledMultiplyGraph(graph, A, B, C_dag, n, n, n);
+            stats = suite.measure([&] { graph.run(); });
+            suite.add("tiled_dag", base, n, threads, stats, C_dag == C_seq);
         }
     }
+    return suite.finish();
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    bench::Options opt(argc, argv);
+    if (!opt.interactive()) return run_benchmark(opt);
+
     // Matrix dimensions
     int m, n, p;
     cout << "Enter matrix dimensions (m n p) for A[m×n] * B[n×p]: ";
@@ -77,6 +171,7 @@ int main() {
     vector<vector<int>> B(n, vector<int>(p));
     vector<vector<int>> C_seq(m, vector<int>(p));
     vector<vector<int>> C_par(m, vector<int>(p));
+    vector<vector<int>> C_dag(m, vector<int>(p));
     
     srand(time(0));
     initializeMatrix(A, m, n);
@@ -88,23 +183,43 @@ int main() {
         printMatrix(B, "B");
     }
 
+    // Hardware counters, reported per element of C
+    perf::Session counters;
+    const double elements = (double)m * p;
+
     // Sequential multiplication
+    counters.start(1);
     auto start_seq = high_resolution_clock::now();
     sequentialMultiply(A, B, C_seq, m, n, p);
     auto stop_seq = high_resolution_clock::now();
+    auto seq_counters = counters.stop();
     auto duration_seq = duration_cast<microseconds>(stop_seq - start_seq);
 
     // Parallel multiplication
+    counters.start();
     auto start_par = high_resolution_clock::now();
     parallelMultiply(A, B, C_par, m, n, p);
     auto stop_par = high_resolution_clock::now();
+    auto par_counters = counters.stop();
     auto duration_par = duration_cast<microseconds>(stop_par - start_par);
 
+    // Tiled task graph multiplication; building the graph is timed separately
+    tg::TaskGraph graph;
+    auto start_build = high_resolution_clock::now();
+    buildTiledMultiplyGraph(graph, A, B, C_dag, m, n, p);
+    auto duration_build = duration_cast<microseconds>(high_resolution_clock::now() - start_build);
+    counters.start();
+    auto start_dag = high_resolution_clock::now();
+    graph.run();
+    auto stop_dag = high_resolution_clock::now();
+    auto dag_counters = counters.stop();
+    auto duration_dag = duration_cast<microseconds>(stop_dag - start_dag);
+
     // Verify results
     bool results_match = true;
     for (int i = 0; i < m && results_match; ++i) {
         for (int j = 0; j < p; ++j) {
-            if (C_seq[i][j] != C_par[i][j]) {
+            if (C_seq[i][j] != C_par[i][j] || C_seq[i][j] != C_dag[i][j]) {
                 results_match = false;
                 break;
             }
@@ -125,14 +240,28 @@ int main() {
     } else {
         cout << "\nSpeedup factor: Too fast to measure";
     }
+    cout << "\nTiled task graph time: " << duration_dag.count() << " μs (built once in " << duration_build.count() << " μs)";
+    if (duration_dag.count() > 0) {
+        double speedup = static_cast<double>(duration_seq.count()) / duration_dag.count();
+        cout << "\nTiled task graph speedup: " << fixed << setprecision(2) << speedup << "x";
+    }
     
     cout << "\nResults match: " << (results_match ? "Yes" : "No") << endl;
 
+    cout << "\n";
+    perf::print(cout, seq_counters, "element", elements, "Sequential counters");
+    perf::print(cout, par_counters, "element", elements, "Parallel counters");
+    perf::print(cout, dag_counters, "element", elements, "Tiled task graph counters");
+
     // Print result matrices if they're small
     if (m <= 10 && p <= 10) {
         printMatrix(C_seq, "Sequential Result");
         printMatrix(C_par, "Parallel Result");
     }
 
+#ifdef PARALLEL_TRACE
+    if (trace::write_chrome_json("matrix_trace.json")) cout << "\nTrace written to matrix_trace.json\n";
+#endif
+
     return 0;
 }
\ No newline at end of file
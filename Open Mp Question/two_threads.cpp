@@ -1,5 +1,6 @@
 #include <iostream>
 #include <omp.h>
+#include "../Work_Stealing/work_stealing.h"
 
 using namespace std;
 
@@ -87,6 +88,41 @@ void example4() {
     cout << "\n";
 }
 
+// Example 5: Example 3 on the work-stealing pool
+void example5() {
+    cout << "\n--- Example 5: Work-stealing tasks without sync ---\n";
+    
+    ws::ThreadPool pool(2);
+    
+    {
+        ws::TaskGroup group(pool);
+        cout << "A ";
+        group.spawn([] {cout << "race ";});
+        group.spawn([] {cout << "car ";});
+        cout << "is fun to watch ";
+    } // Group destructor waits, like the end of the parallel region
+    
+    cout << "\n";
+}
+
+// Example 6: Example 4 on the work-stealing pool
+void example6() {
+    cout << "\n--- Example 6: Work-stealing tasks with sync ---\n";
+    
+    ws::ThreadPool pool(2);
+    
+    {
+        ws::TaskGroup group(pool);
+        cout << "A ";
+        group.spawn([] {cout << "car ";});
+        group.spawn([] {cout << "race ";});
+        group.sync();
+        cout << "is fun to watch ";
+    }
+    
+    cout << "\n";
+}
+
 int main() {
     cout << "Running OpenMP examples with 2 threads\n";
     
@@ -102,6 +138,8 @@ int main() {
     example2();
     example3();
     example4();
+    example5();
+    example6();
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,462 @@
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <string>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <new>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "../Benchmark/bench.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// Directed graph in compressed sparse row form
+struct CSRGraph {
+    int V = 0;
+    vector<long long> offsets;
+    vector<int> dest;
+};
+
+// Same shape as the BFS program's generator, but seeded and sequential
+// (the parent must not start OpenMP threads before it forks)
+CSRGraph generate_graph(int vertices, int edge_density, unsigned seed) {
+    CSRGraph g;
+    g.V = vertices;
+    g.offsets.resize(vertices + 1);
+    g.dest.reserve((size_t)vertices * edge_density);
+    mt19937 gen(seed);
+    uniform_int_distribution<> dest_dist(0, vertices - 1);
+    for (int i = 0; i < vertices; ++i) {
+        g.offsets[i] = (long long)g.dest.size();
+        for (int j = 0; j < edge_density; ++j) {
+            int dest = dest_dist(gen);
+            // Avoid self-loops
+            if (dest == i) dest = (dest < vertices - 1) ? dest + 1 : dest - 1;
+            g.dest.push_back(dest);
+        }
+    }
+    g.offsets[vertices] = (long long)g.dest.size();
+    return g;
+}
+
+// Sequential BFS levels (-1 for unreachable), the reference
+vector<int> bfs_seq(const CSRGraph& g, int start) {
+    vector<int> level(g.V, -1);
+    queue<int> q;
+    level[start] = 0;
+    q.push(start);
+    while (!q.empty()) {
+        int u = q.front();
+        q.pop();
+        for (long long e = g.offsets[u]; e < g.offsets[u + 1]; ++e) {
+            int v = g.dest[e];
+            if (level[v] < 0) {
+                level[v] = level[u] + 1;
+                q.push(v);
+            }
+        }
+    }
+    return level;
+}
+
+// Single-producer single-consumer ring of vertex ids in shared memory.
+// head and tail only grow; they sit on separate cache lines.
+struct RingHeader {
+    alignas(64) atomic<uint64_t> head; // next slot to read, written by the consumer
+    alignas(64) atomic<uint64_t> tail; // next slot to write, written by the producer
+};
+
+// State shared by the parent and every worker, followed in the same
+// mapping by the ring headers, the ring slots and the result levels
+struct SharedState {
+    // Parent <-> workers: the parent bumps generation to start a run (or to
+    // exit), workers count themselves into finished. A robust mutex and
+    // condition variables rather than a barrier, so the parent can wait
+    // with a timeout and notice a dead worker instead of blocking forever.
+    pthread_mutex_t control;
+    pthread_cond_t go;
+    pthread_cond_t all_finished;
+    int64_t generation;          // guarded by control
+    int finished;                // workers done with the current run, guarded by control
+    pthread_barrier_t level_end; // workers: end of every BFS level
+    alignas(64) atomic<int64_t> done;       // level-done marks, one per worker per level
+    alignas(64) atomic<int64_t> discovered; // vertices reached, over all levels
+    alignas(64) atomic<int64_t> messages;   // remote vertex ids sent
+    atomic<int64_t> batches;                // ring pushes
+    atomic<int> start;
+    atomic<bool> exit;
+};
+
+// N worker processes, each owning the vertex range [w * chunk, (w + 1) * chunk)
+// and that range's out-edges, visited levels and frontier. A level runs in
+// three steps: expand the local frontier, sending remote targets in batches
+// through ring[w -> owner]; mark the level done and drain the incoming rings
+// until all workers are done; wait at the level barrier.
+class Cluster {
+public:
+    Cluster(const CSRGraph& g, int workers, int ring_capacity, int batch, bool pin)
+        : V_(g.V), workers_(workers), chunk_((g.V + workers - 1) / workers),
+          ring_capacity_(ring_capacity), batch_(batch) {
+        // One anonymous shared mapping holds everything
+        size_t header = (sizeof(SharedState) + 63) / 64 * 64;
+        size_t rings = (size_t)workers * workers * sizeof(RingHeader);
+        size_t slots = (size_t)workers * workers * ring_capacity * sizeof(int32_t);
+        bytes_ = header + rings + slots + (size_t)V_ * sizeof(int32_t);
+        void* mem = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            error_ = string("mmap: ") + strerror(errno);
+            return;
+        }
+        char* base = (char*)mem;
+        shared_ = new (base) SharedState();
+        rings_ = (RingHeader*)(base + header);
+        for (int i = 0; i < workers * workers; ++i) new (&rings_[i]) RingHeader();
+        slots_ = (int32_t*)(base + header + rings);
+        levels_ = (int32_t*)(base + header + rings + slots);
+
+        pthread_mutexattr_t mutex_attr;
+        pthread_mutexattr_init(&mutex_attr);
+        pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&shared_->control, &mutex_attr);
+        pthread_mutexattr_destroy(&mutex_attr);
+        pthread_condattr_t cond_attr;
+        pthread_condattr_init(&cond_attr);
+        pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+        pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&shared_->go, &cond_attr);
+        pthread_cond_init(&shared_->all_finished, &cond_attr);
+        pthread_condattr_destroy(&cond_attr);
+        pthread_barrierattr_t attr;
+        pthread_barrierattr_init(&attr);
+        pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_barrier_init(&shared_->level_end, &attr, workers);
+        pthread_barrierattr_destroy(&attr);
+
+        cout.flush();
+        for (int w = 0; w < workers; ++w) {
+            pid_t pid = fork();
+            if (pid < 0) {
+                error_ = string("fork: ") + strerror(errno);
+                // Workers already started would wait for a run forever
+                for (pid_t p : pids_) kill(p, SIGKILL);
+                return;
+            }
+            if (pid == 0) {
+                if (pin) {
+                    cpu_set_t set;
+                    CPU_ZERO(&set);
+                    CPU_SET(w % (int)sysconf(_SC_NPROCESSORS_ONLN), &set);
+                    sched_setaffinity(0, sizeof(set), &set);
+                }
+                worker(g, w);
+                _exit(0);
+            }
+            pids_.push_back(pid);
+        }
+    }
+
+    ~Cluster() {
+        if (!shared_) return;
+        if (error_.empty()) {
+            // Every worker is waiting for the next run; none can block the exit
+            shared_->exit.store(true);
+            lock();
+            shared_->generation++;
+            pthread_cond_broadcast(&shared_->go);
+            pthread_mutex_unlock(&shared_->control);
+        }
+        for (pid_t pid : pids_) waitpid(pid, nullptr, 0);
+        pthread_cond_destroy(&shared_->go);
+        pthread_cond_destroy(&shared_->all_finished);
+        pthread_mutex_destroy(&shared_->control);
+        pthread_barrier_destroy(&shared_->level_end);
+        munmap(shared_, bytes_);
+    }
+
+    Cluster(const Cluster&) = delete;
+    Cluster& operator=(const Cluster&) = delete;
+
+    bool ok() const { return error_.empty(); }
+    const string& error() const { return error_; }
+    size_t shared_bytes() const { return bytes_; }
+    int64_t messages() const { return shared_->messages.load(); }
+    int64_t batches() const { return shared_->batches.load(); }
+
+    // One BFS from start; returns when every worker has finished. If a
+    // worker dies, the others are killed and ok() turns false; later runs
+    // then return at once.
+    void run(int start) {
+        if (!ok()) return;
+        shared_->start.store(start);
+        lock();
+        shared_->finished = 0;
+        shared_->generation++;
+        pthread_cond_broadcast(&shared_->go);
+        while (shared_->finished < workers_) {
+            timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_nsec += 100 * 1000000L; // check on the workers every 100 ms
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            const int rc = pthread_cond_timedwait(&shared_->all_finished, &shared_->control, &deadline);
+            if (rc == EOWNERDEAD) pthread_mutex_consistent(&shared_->control);
+            if (rc != 0 && reap_dead_worker()) break;
+        }
+        pthread_mutex_unlock(&shared_->control);
+    }
+
+    // Levels of the last run, -1 for unreachable
+    vector<int> levels() const { return vector<int>(levels_, levels_ + V_); }
+
+private:
+    // The control mutex is robust: a worker that died holding it hands it
+    // over with EOWNERDEAD instead of leaving it locked
+    void lock() {
+        if (pthread_mutex_lock(&shared_->control) == EOWNERDEAD) pthread_mutex_consistent(&shared_->control);
+    }
+
+    // If a worker has exited, records the error, kills and reaps the rest
+    // (they would wait for it forever) and returns true
+    bool reap_dead_worker() {
+        for (size_t w = 0; w < pids_.size(); ++w) {
+            int status = 0;
+            if (waitpid(pids_[w], &status, WNOHANG) != pids_[w]) continue;
+            if (WIFSIGNALED(status))
+                error_ = "worker " + to_string(w) + " killed by signal " + to_string(WTERMSIG(status)) + " (" + strsignal(WTERMSIG(status)) + ")";
+            else
+                error_ = "worker " + to_string(w) + " exited with status " + to_string(WEXITSTATUS(status));
+            pids_.erase(pids_.begin() + w);
+            for (pid_t p : pids_) kill(p, SIGKILL);
+            for (pid_t p : pids_) waitpid(p, nullptr, 0);
+            pids_.clear();
+            return true;
+        }
+        return false;
+    }
+
+    RingHeader& ring(int from, int to) const { return rings_[from * workers_ + to]; }
+    int32_t* slots(int from, int to) const { return slots_ + ((size_t)from * workers_ + to) * ring_capacity_; }
+
+    void worker(const CSRGraph& g, int w) {
+        const int lo = min(V_, w * chunk_), hi = min(V_, lo + chunk_), owned = hi - lo;
+
+        // Copy this worker's slice of the graph, so its pages are first
+        // touched (and placed) by the process that uses them
+        vector<long long> offsets(owned + 1);
+        for (int u = lo; u <= hi; ++u) offsets[u - lo] = g.offsets[u] - g.offsets[lo];
+        vector<int> dest(g.dest.begin() + g.offsets[lo], g.dest.begin() + g.offsets[hi]);
+
+        vector<int> level(owned);
+        vector<int> frontier, next;
+        vector<vector<int32_t>> outbox(workers_);
+        for (auto& box : outbox) box.reserve(batch_);
+        int64_t levels_done = 0; // levels over all runs, the same in every worker
+        int64_t messages = 0, batches = 0;
+
+        // Incoming vertex: first visit sets its level and queues it
+        auto visit = [&](int v, int depth) {
+            int& l = level[v - lo];
+            if (l < 0) {
+                l = depth;
+                next.push_back(v);
+            }
+        };
+        // Everything currently in the rings addressed to this worker
+        auto drain = [&](int depth) {
+            for (int from = 0; from < workers_; ++from) {
+                if (from == w) continue;
+                RingHeader& r = ring(from, w);
+                const int32_t* data = slots(from, w);
+                uint64_t head = r.head.load(memory_order_relaxed);
+                const uint64_t tail = r.tail.load(memory_order_acquire);
+                for (; head < tail; ++head) visit(data[head % ring_capacity_], depth);
+                r.head.store(head, memory_order_release);
+            }
+        };
+        // One batch into ring[w -> to]; drains while the ring is full, so
+        // two workers sending to each other cannot deadlock. Kept out of
+        // line: inlined into the expand loop it made that loop ~30% slower.
+        auto flush = [&](int to, int depth) __attribute__((noinline)) {
+            vector<int32_t>& box = outbox[to];
+            if (box.empty()) return;
+            RingHeader& r = ring(w, to);
+            int32_t* data = slots(w, to);
+            const uint64_t tail = r.tail.load(memory_order_relaxed);
+            while (tail + box.size() - r.head.load(memory_order_acquire) > (uint64_t)ring_capacity_) {
+                drain(depth);
+                sched_yield();
+            }
+            for (size_t i = 0; i < box.size(); ++i) data[(tail + i) % ring_capacity_] = box[i];
+            r.tail.store(tail + box.size(), memory_order_release);
+            messages += (int64_t)box.size();
+            batches++;
+            box.clear();
+        };
+
+        int64_t generation = 0;
+        while (true) {
+            lock();
+            while (shared_->generation == generation) {
+                if (pthread_cond_wait(&shared_->go, &shared_->control) == EOWNERDEAD)
+                    pthread_mutex_consistent(&shared_->control);
+            }
+            generation = shared_->generation;
+            pthread_mutex_unlock(&shared_->control);
+            if (shared_->exit.load()) return;
+            const int start = shared_->start.load();
+
+            fill(level.begin(), level.end(), -1);
+            frontier.clear();
+            if (start >= lo && start < hi) {
+                level[start - lo] = 0;
+                frontier.push_back(start);
+            }
+            // Stable here: the previous run's additions ended before every
+            // worker finished it, this run's start after every worker's first done mark
+            int64_t reached = shared_->discovered.load();
+
+            for (int depth = 1;; ++depth) {
+                next.clear();
+                int* local_level = level.data();
+                for (int u : frontier) {
+                    for (long long e = offsets[u - lo]; e < offsets[u - lo + 1]; ++e) {
+                        const int v = dest[e];
+                        if ((unsigned)(v - lo) < (unsigned)owned) { // one compare for lo <= v < hi
+                            int& l = local_level[v - lo];
+                            if (l < 0) {
+                                l = depth;
+                                next.push_back(v);
+                            }
+                        } else {
+                            const int to = v / chunk_;
+                            outbox[to].push_back(v);
+                            if ((int)outbox[to].size() == batch_) flush(to, depth);
+                        }
+                    }
+                }
+                for (int to = 0; to < workers_; ++to) flush(to, depth);
+
+                // Done sending; receive until every worker is done with this level
+                shared_->done.fetch_add(1, memory_order_release);
+                ++levels_done;
+                while (shared_->done.load(memory_order_acquire) < levels_done * workers_) {
+                    drain(depth);
+                    sched_yield();
+                }
+                drain(depth); // batches pushed before the last done mark
+
+                shared_->discovered.fetch_add((int64_t)next.size());
+                pthread_barrier_wait(&shared_->level_end);
+                // Nothing can be added again before every worker has read
+                // this: the next additions come after the next level's done wait
+                const int64_t total = shared_->discovered.load();
+                if (total == reached) break; // no worker found anything new
+                reached = total;
+                frontier.swap(next);
+            }
+
+            if (owned > 0) memcpy(levels_ + lo, level.data(), owned * sizeof(int32_t));
+            shared_->messages.fetch_add(messages);
+            shared_->batches.fetch_add(batches);
+            messages = batches = 0;
+            lock();
+            if (++shared_->finished == workers_) pthread_cond_signal(&shared_->all_finished);
+            pthread_mutex_unlock(&shared_->control);
+        }
+    }
+
+    int V_;
+    int workers_;
+    int chunk_;
+    int ring_capacity_;
+    int batch_;
+    size_t bytes_ = 0;
+    SharedState* shared_ = nullptr;
+    RingHeader* rings_ = nullptr;
+    int32_t* slots_ = nullptr;
+    int32_t* levels_ = nullptr;
+    vector<pid_t> pids_;
+    string error_;
+};
+
+int main(int argc, char* argv[]) {
+    bench::Options opt(argc, argv);
+    auto known = bench::Suite::common_options();
+    known.insert({"density", "start", "seed", "ring", "batch", "pin"});
+    opt.check_known(known);
+    if (opt.has("help")) {
+        cout << "Usage: partitioned_bfs [options]   (--threads is the number of worker processes)\n"
+             << "  --density=N       edges per vertex (default 8)\n"
+             << "  --start=V         start vertex (default 0)\n"
+             << "  --seed=S          random graph seed (default 1)\n"
+             << "  --ring=N          vertex ids per ring buffer (default 65536)\n"
+             << "  --batch=N         vertex ids per message batch (default 256)\n"
+             << "  --pin             pin worker w to CPU w\n";
+        bench::Suite::print_common_help();
+        return 0;
+    }
+
+    bench::Suite suite("partitioned_bfs", opt, {1000000}, "vertices");
+    const int edge_density = (int)opt.get_int("density", 8);
+    const int start_vertex = (int)opt.get_int("start", 0);
+    const unsigned seed = (unsigned)opt.get_int("seed", 1);
+    const int ring_capacity = (int)opt.get_int("ring", 65536);
+    const int batch = (int)opt.get_int("batch", 256);
+    const bool pin = opt.has("pin");
+    if (edge_density <= 0) opt.error("--density must be positive");
+    if (batch <= 0 || ring_capacity < batch) opt.error("need 0 < --batch <= --ring");
+    for (long long base : suite.sizes()) {
+        if (start_vertex < 0 || start_vertex >= base) opt.error("--start must be a vertex of every graph size");
+    }
+    if (opt.report_errors()) return 1;
+
+    for (long long base : suite.sizes()) {
+        long long built = -1;
+        CSRGraph graph;
+        vector<int> reference;
+        for (int workers : suite.threads()) {
+            const long long vertices = suite.size_for(base, workers);
+            if (vertices != built) {
+                graph = generate_graph((int)vertices, edge_density, seed);
+                reference = bfs_seq(graph, start_vertex);
+                suite.add("seq", base, vertices, 1, suite.measure([&] { bfs_seq(graph, start_vertex); }), true);
+                built = vertices;
+            }
+
+            Cluster cluster(graph, workers, ring_capacity, batch, pin);
+            if (!cluster.ok()) {
+                cerr << "Error: " << cluster.error() << "\n";
+                return 1;
+            }
+            bench::Stats stats = suite.measure([&] { cluster.run(start_vertex); });
+            if (!cluster.ok()) {
+                cerr << "Error: " << cluster.error() << "\n";
+                return 1;
+            }
+            // Copied out of shared memory after timing, as seq has no such copy
+            suite.add("procs", base, vertices, workers, stats, cluster.levels() == reference);
+            const int runs = suite.warmup() + suite.reps();
+            if (cluster.batches() > 0) {
+                cout << "  " << workers << " processes: " << cluster.messages() / runs << " remote updates in "
+                     << cluster.batches() / runs << " batches per BFS ("
+                     << fixed << setprecision(1) << (double)cluster.messages() / cluster.batches()
+                     << " per batch), " << cluster.shared_bytes() / 1048576 << " MiB shared\n";
+            }
+        }
+    }
+    return suite.finish();
+}
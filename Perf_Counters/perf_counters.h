@@ -0,0 +1,279 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+// Hardware performance counters through Linux perf_event_open.
+//
+//   perf::Session counters;
+//   counters.start();              // opens a counter group on every OpenMP thread
+//   bfs_par(graph, start);         // (counters.start(1) around sequential kernels)
+//   perf::Sample s = counters.stop();
+//   perf::print(cout, s, "edge", num_edges);
+//
+// Each thread opens one group (cycles as leader, then instructions, L1D and
+// LLC read misses, branch misses and dTLB misses) for itself, so the values
+// are summed over the threads that ran the kernel. Counters the CPU or
+// kernel does not offer are skipped, and if nothing can be opened (common
+// in containers and VMs, or with a strict perf_event_paranoid) the sample
+// is marked unavailable with the reason instead of failing.
+//
+// OpenMP keeps the same worker threads across parallel regions of equal
+// size, so the groups opened in start() are the ones that run the kernel.
+
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <omp.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace perf {
+
+enum Counter {
+    CYCLES,
+    INSTRUCTIONS,
+    L1D_MISSES,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    DTLB_MISSES,
+    NUM_COUNTERS
+};
+
+inline const char* counter_name(int c) {
+    static const char* names[NUM_COUNTERS] = {
+        "cycles", "instructions", "L1D misses", "LLC misses", "branch misses", "dTLB misses"
+    };
+    return names[c];
+}
+
+struct Sample {
+    double value[NUM_COUNTERS] = {};
+    bool valid[NUM_COUNTERS] = {};
+    double seconds = 0.0;
+    bool available = false;
+    std::string error;
+};
+
+#ifdef __linux__
+
+inline perf_event_attr counter_attr(int c) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.exclude_kernel = 1; // allowed with perf_event_paranoid <= 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    auto cache = [](uint64_t cache_id, uint64_t op, uint64_t result) {
+        return cache_id | (op << 8) | (result << 16);
+    };
+
+    switch (c) {
+    case CYCLES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case INSTRUCTIONS:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case L1D_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+        break;
+    case LLC_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cache(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+        break;
+    case BRANCH_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    case DTLB_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+        break;
+    }
+    return attr;
+}
+
+// Counter group of the calling thread
+class ThreadGroup {
+public:
+    ThreadGroup() {
+        for (int c = 0; c < NUM_COUNTERS; ++c) fd_[c] = -1;
+    }
+
+    ~ThreadGroup() { close(); }
+
+    ThreadGroup(const ThreadGroup&) = delete;
+    ThreadGroup& operator=(const ThreadGroup&) = delete;
+
+    // Returns false (with error()) when not even the leader can be opened
+    bool open() {
+        for (int c = 0; c < NUM_COUNTERS; ++c) {
+            perf_event_attr attr = counter_attr(c);
+            int group = leader();
+            attr.disabled = group < 0; // the leader starts disabled, members follow it
+            int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+            if (fd < 0) {
+                if (error_.empty()) error_ = std::string("perf_event_open: ") + strerror(errno);
+                continue; // unsupported counter: skip it
+            }
+            fd_[c] = fd;
+            order_.push_back(c);
+        }
+        return leader() >= 0;
+    }
+
+    void enable() {
+        if (leader() >= 0) {
+            ioctl(leader(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    void disable() {
+        if (leader() >= 0) ioctl(leader(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    // Adds this thread's counts into s, scaled up if the group was multiplexed
+    bool read_into(Sample& s) {
+        if (leader() < 0) return false;
+        std::vector<uint64_t> buf(3 + order_.size());
+        ssize_t n = ::read(leader(), buf.data(), buf.size() * sizeof(uint64_t));
+        if (n < (ssize_t)(3 * sizeof(uint64_t))) return false;
+
+        const uint64_t nr = buf[0], enabled = buf[1], running = buf[2];
+        if (running == 0) return false; // never scheduled on the PMU
+        const double scale = (double)enabled / running;
+        for (uint64_t i = 0; i < nr && i < order_.size(); ++i) {
+            s.value[order_[i]] += buf[3 + i] * scale;
+            s.valid[order_[i]] = true;
+        }
+        return true;
+    }
+
+    void close() {
+        for (int c = 0; c < NUM_COUNTERS; ++c) {
+            if (fd_[c] >= 0) ::close(fd_[c]);
+            fd_[c] = -1;
+        }
+        order_.clear();
+    }
+
+    const std::string& error() const { return error_; }
+
+private:
+    int leader() const { return order_.empty() ? -1 : fd_[order_[0]]; }
+
+    int fd_[NUM_COUNTERS];
+    std::vector<int> order_; // counters in group order
+    std::string error_;
+};
+
+#else
+
+class ThreadGroup {
+public:
+    bool open() { return false; }
+    void enable() {}
+    void disable() {}
+    bool read_into(Sample&) { return false; }
+    void close() {}
+    const std::string& error() const { return error_; }
+private:
+    std::string error_ = "perf_event_open is Linux only";
+};
+
+#endif // __linux__
+
+// Counts on the threads that run the kernel between start() and stop()
+class Session {
+public:
+    // team_size threads of the OpenMP team; 0 means omp_get_max_threads().
+    // Pass 1 for sequential kernels: only the calling thread is counted, so
+    // idle OpenMP workers spinning in their barrier are not added in.
+    void start(int team_size = 0) {
+        const int n = team_size > 0 ? team_size : omp_get_max_threads();
+        groups_.clear();
+        for (int t = 0; t < n; ++t) groups_.emplace_back(new ThreadGroup());
+
+        if (n == 1) {
+            if (groups_[0]->open()) groups_[0]->enable();
+        } else {
+            #pragma omp parallel num_threads(n)
+            {
+                ThreadGroup& g = *groups_[omp_get_thread_num()];
+                if (g.open()) g.enable();
+            }
+        }
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    Sample stop() {
+        Sample s;
+        s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+
+        if (groups_.size() == 1) {
+            groups_[0]->disable();
+        } else {
+            #pragma omp parallel num_threads((int)groups_.size())
+            groups_[omp_get_thread_num()]->disable();
+        }
+
+        for (auto& g : groups_) {
+            if (g->read_into(s)) s.available = true;
+            else if (s.error.empty()) s.error = g->error();
+            g->close();
+        }
+        if (!s.available && s.error.empty()) s.error = "counters were never scheduled";
+        return s;
+    }
+
+private:
+    std::vector<std::unique_ptr<ThreadGroup>> groups_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// One-line summary: IPC, misses per unit of work and LLC-miss bandwidth
+inline void print(std::ostream& out, const Sample& s, const char* unit, double units,
+                  const char* label = "Counters") {
+    if (!s.available) {
+        out << label << ": unavailable (" << s.error << ")\n";
+        return;
+    }
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(3);
+    const char* sep = " ";
+    if (s.valid[CYCLES] && s.valid[INSTRUCTIONS] && s.value[CYCLES] > 0) {
+        line << sep << "IPC " << s.value[INSTRUCTIONS] / s.value[CYCLES];
+        sep = ", ";
+    }
+    for (int c = L1D_MISSES; c < NUM_COUNTERS; ++c) {
+        if (s.valid[c] && units > 0) {
+            line << sep << counter_name(c) << "/" << unit << " " << s.value[c] / units;
+            sep = ", ";
+        }
+    }
+    if (s.valid[LLC_MISSES] && s.seconds > 0) {
+        // Every LLC miss moves one 64-byte line from memory
+        line << sep << "est. bandwidth " << std::setprecision(2) << s.value[LLC_MISSES] * 64.0 / s.seconds / 1e9 << " GB/s";
+    }
+    out << label << ":" << line.str() << "\n";
+}
+
+} // namespace perf
+
+#endif // PERF_COUNTERS_H
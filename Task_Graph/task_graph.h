@@ -0,0 +1,213 @@
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+// Task-dependency graph executor.
+//
+// Tasks declare how they access data regions, like OpenMP `depend` clauses:
+//   in(p)     read region p    -> runs after the last writer of p
+//   out(p)    write region p   -> runs after the last writer and all readers
+//   inout(p)  both
+// Edges are derived in insertion order, so the graph is built exactly like a
+// sequential program would run. Ready tasks are taken highest critical path
+// first (longest remaining chain of dependent work, weighted by cost), which
+// keeps the long chain moving while independent work fills the gaps.
+//
+// A graph can be run any number of times; tasks capture their data by
+// reference, so only the data changes between iterations.
+//
+//   tg::TaskGraph g;
+//   g.add([&] { potrf(A00); }, {tg::inout(&A00)}, 1.0);
+//   g.add([&] { trsm(A00, A10); }, {tg::in(&A00), tg::inout(&A10)}, 3.0);
+//   g.run();
+
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <initializer_list>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <omp.h>
+
+namespace tg {
+
+enum class Access { IN, OUT, INOUT };
+
+struct Dep {
+    const void* region;
+    Access mode;
+};
+
+inline Dep in(const void* region) { return {region, Access::IN}; }
+inline Dep out(const void* region) { return {region, Access::OUT}; }
+inline Dep inout(const void* region) { return {region, Access::INOUT}; }
+
+class TaskGraph {
+public:
+    // Adds a task and returns its id. cost is a relative weight (e.g. flops)
+    // used only for the critical-path priority.
+    int add(std::function<void()> fn, std::initializer_list<Dep> deps, double cost = 1.0) {
+        const int id = (int)nodes_.size();
+        nodes_.emplace_back();
+        Node& node = nodes_.back();
+        node.fn = std::move(fn);
+        node.cost = cost;
+
+        for (const Dep& dep : deps) {
+            Region& r = regions_[dep.region];
+            if (r.last_writer >= 0) add_edge(r.last_writer, id);
+            if (dep.mode == Access::IN) {
+                r.readers.push_back(id);
+            } else {
+                for (int reader : r.readers) add_edge(reader, id);
+                r.readers.clear();
+                r.last_writer = id;
+            }
+        }
+        finalized_ = false;
+        return id;
+    }
+
+    // Executes every task once, respecting dependencies
+    void run(int num_threads = 0) {
+        if (nodes_.empty()) return;
+        finalize();
+        if (num_threads <= 0) num_threads = omp_get_max_threads();
+
+        std::vector<std::atomic<int>> pending(nodes_.size());
+        ReadyQueue ready;
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            pending[i].store(nodes_[i].num_pred, std::memory_order_relaxed);
+            if (nodes_[i].num_pred == 0) ready.emplace(nodes_[i].priority, (int)i);
+        }
+
+        std::mutex m;
+        std::condition_variable cv;
+        size_t remaining = nodes_.size();
+        std::vector<double> busy(num_threads, 0.0);
+
+        auto start = std::chrono::steady_clock::now();
+
+        #pragma omp parallel num_threads(num_threads)
+        {
+            const int t = omp_get_thread_num();
+            std::vector<int> newly_ready;
+            std::unique_lock<std::mutex> lock(m);
+            while (true) {
+                cv.wait(lock, [&] { return !ready.empty() || remaining == 0; });
+                if (ready.empty()) break; // remaining == 0
+                const int id = ready.top().second;
+                ready.pop();
+                lock.unlock();
+
+                auto t0 = std::chrono::steady_clock::now();
+                nodes_[id].fn();
+                busy[t] += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+                newly_ready.clear();
+                for (int s : nodes_[id].succ) {
+                    if (pending[s].fetch_sub(1, std::memory_order_acq_rel) == 1) newly_ready.push_back(s);
+                }
+
+                lock.lock();
+                for (int s : newly_ready) ready.emplace(nodes_[s].priority, s);
+                --remaining;
+                if (remaining == 0) cv.notify_all();
+                else if (newly_ready.size() > 1) cv.notify_all();
+                else if (newly_ready.size() == 1) cv.notify_one();
+            }
+        }
+
+        last_wall_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        last_busy_ = 0;
+        for (double b : busy) last_busy_ += b;
+        last_threads_ = num_threads;
+    }
+
+    size_t size() const { return nodes_.size(); }
+
+    size_t num_edges() const {
+        size_t e = 0;
+        for (const Node& n : nodes_) e += n.succ.size();
+        return e;
+    }
+
+    // Sum of task costs and cost of the longest dependency chain
+    double total_cost() const {
+        double c = 0;
+        for (const Node& n : nodes_) c += n.cost;
+        return c;
+    }
+
+    double critical_path() {
+        finalize();
+        double cp = 0;
+        for (const Node& n : nodes_) cp = std::max(cp, n.priority);
+        return cp;
+    }
+
+    // Wall time of the last run() in seconds
+    double last_run_seconds() const { return last_wall_; }
+
+    // Fraction of thread time spent inside tasks during the last run()
+    double last_utilization() const {
+        return last_wall_ > 0 ? last_busy_ / (last_wall_ * last_threads_) : 0.0;
+    }
+
+    void clear() {
+        nodes_.clear();
+        regions_.clear();
+        finalized_ = false;
+    }
+
+private:
+    struct Node {
+        std::function<void()> fn;
+        double cost = 1.0;
+        double priority = 0.0; // cost of the longest path from here to a sink
+        int num_pred = 0;
+        std::vector<int> succ;
+    };
+
+    struct Region {
+        int last_writer = -1;
+        std::vector<int> readers;
+    };
+
+    typedef std::priority_queue<std::pair<double, int>> ReadyQueue;
+
+    void add_edge(int from, int to) {
+        if (from == to) return;
+        std::vector<int>& succ = nodes_[from].succ;
+        // Edges into `to` are added consecutively, so this catches duplicates
+        if (!succ.empty() && succ.back() == to) return;
+        succ.push_back(to);
+        nodes_[to].num_pred++;
+    }
+
+    // Bottom levels; ids are a topological order since edges go to later tasks
+    void finalize() {
+        if (finalized_) return;
+        for (int i = (int)nodes_.size() - 1; i >= 0; --i) {
+            double longest = 0;
+            for (int s : nodes_[i].succ) longest = std::max(longest, nodes_[s].priority);
+            nodes_[i].priority = nodes_[i].cost + longest;
+        }
+        finalized_ = true;
+    }
+
+    std::vector<Node> nodes_;
+    std::unordered_map<const void*, Region> regions_;
+    bool finalized_ = false;
+
+    double last_wall_ = 0;
+    double last_busy_ = 0;
+    int last_threads_ = 1;
+};
+
+} // namespace tg
+
+#endif // TASK_GRAPH_H
@@ -0,0 +1,325 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <omp.h>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include "task_graph.h"
+#include "../Benchmark/bench.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// Symmetric matrix stored as T x T tiles of nb x nb doubles (row-major).
+// Only the lower triangle of tiles is used.
+struct TiledMatrix {
+    int T;
+    int nb;
+    vector<vector<double>> tiles;
+
+    TiledMatrix(int tiles_per_dim, int tile_size) : T(tiles_per_dim), nb(tile_size) {
+        tiles.resize(T * T, vector<double>(nb * nb, 0.0));
+    }
+
+    double* tile(int i, int j) { return tiles[i * T + j].data(); }
+
+    double get(int r, int c) const {
+        return tiles[(r / nb) * T + (c / nb)][(r % nb) * nb + (c % nb)];
+    }
+};
+
+// Overwrites dst's values with src's without reallocating, so tiles keep
+// their addresses (a built task graph holds pointers to them)
+void copy_values(TiledMatrix& dst, const TiledMatrix& src) {
+    for (size_t t = 0; t < src.tiles.size(); ++t) {
+        copy(src.tiles[t].begin(), src.tiles[t].end(), dst.tiles[t].begin());
+    }
+}
+
+// Random symmetric, diagonally dominant (hence positive definite) matrix
+TiledMatrix generate_spd(int T, int nb) {
+    TiledMatrix A(T, nb);
+    const int n = T * nb;
+    mt19937 gen(42);
+    uniform_real_distribution<> dist(0.0, 1.0);
+    for (int r = 0; r < n; ++r) {
+        for (int c = 0; c <= r; ++c) {
+            double v = dist(gen);
+            if (r == c) v += n;
+            A.tiles[(r / nb) * T + (c / nb)][(r % nb) * nb + (c % nb)] = v;
+            A.tiles[(c / nb) * T + (r / nb)][(c % nb) * nb + (r % nb)] = v;
+        }
+    }
+    return A;
+}
+
+// A = L * L^T of a diagonal tile; the upper part is zeroed
+void potrf(double* A, int nb) {
+    for (int j = 0; j < nb; ++j) {
+        double d = A[j * nb + j];
+        for (int k = 0; k < j; ++k) d -= A[j * nb + k] * A[j * nb + k];
+        d = sqrt(d);
+        A[j * nb + j] = d;
+        for (int i = j + 1; i < nb; ++i) {
+            double s = A[i * nb + j];
+            for (int k = 0; k < j; ++k) s -= A[i * nb + k] * A[j * nb + k];
+            A[i * nb + j] = s / d;
+        }
+        for (int i = 0; i < j; ++i) A[i * nb + j] = 0.0;
+    }
+}
+
+// B = B * L^-T (solve X * L^T = B for the panel tile B)
+void trsm(const double* L, double* B, int nb) {
+    for (int r = 0; r < nb; ++r) {
+        double* x = B + r * nb;
+        for (int j = 0; j < nb; ++j) {
+            double s = x[j];
+            for (int k = 0; k < j; ++k) s -= x[k] * L[j * nb + k];
+            x[j] = s / L[j * nb + j];
+        }
+    }
+}
+
+// C -= A * B^T (SYRK when A == B)
+void gemm_nt(const double* A, const double* B, double* C, int nb) {
+    for (int i = 0; i < nb; ++i) {
+        for (int j = 0; j < nb; ++j) {
+            double s = 0.0;
+            for (int k = 0; k < nb; ++k) s += A[i * nb + k] * B[j * nb + k];
+            C[i * nb + j] -= s;
+        }
+    }
+}
+
+// Sequential tiled Cholesky
+void cholesky_seq(TiledMatrix& A) {
+    const int T = A.T, nb = A.nb;
+    for (int k = 0; k < T; ++k) {
+        potrf(A.tile(k, k), nb);
+        for (int i = k + 1; i < T; ++i) trsm(A.tile(k, k), A.tile(i, k), nb);
+        for (int i = k + 1; i < T; ++i) {
+            for (int j = k + 1; j <= i; ++j) gemm_nt(A.tile(i, k), A.tile(j, k), A.tile(i, j), nb);
+        }
+    }
+}
+
+// Fork/join: every phase of every step ends in a barrier
+void cholesky_fork_join(TiledMatrix& A) {
+    const int T = A.T, nb = A.nb;
+    for (int k = 0; k < T; ++k) {
+        potrf(A.tile(k, k), nb);
+
+        #pragma omp parallel for
+        for (int i = k + 1; i < T; ++i) trsm(A.tile(k, k), A.tile(i, k), nb);
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int i = k + 1; i < T; ++i) {
+            for (int j = k + 1; j <= i; ++j) gemm_nt(A.tile(i, k), A.tile(j, k), A.tile(i, j), nb);
+        }
+    }
+}
+
+// Same kernels as a dependency graph. Costs are relative flop counts.
+void build_cholesky_graph(tg::TaskGraph& g, TiledMatrix& A) {
+    const int T = A.T, nb = A.nb;
+    for (int k = 0; k < T; ++k) {
+        double* akk = A.tile(k, k);
+        g.add([akk, nb] { potrf(akk, nb); }, {tg::inout(akk)}, 1.0 / 3.0);
+
+        for (int i = k + 1; i < T; ++i) {
+            double* aik = A.tile(i, k);
+            g.add([akk, aik, nb] { trsm(akk, aik, nb); }, {tg::in(akk), tg::inout(aik)}, 1.0);
+        }
+
+        for (int i = k + 1; i < T; ++i) {
+            for (int j = k + 1; j <= i; ++j) {
+                double* aik = A.tile(i, k);
+                double* ajk = A.tile(j, k);
+                double* aij = A.tile(i, j);
+                if (i == j) {
+                    g.add([aik, aij, nb] { gemm_nt(aik, aik, aij, nb); }, {tg::in(aik), tg::inout(aij)}, 1.0);
+                } else {
+                    g.add([aik, ajk, aij, nb] { gemm_nt(aik, ajk, aij, nb); },
+                          {tg::in(aik), tg::in(ajk), tg::inout(aij)}, 2.0);
+                }
+            }
+        }
+    }
+}
+
+// max |A - L * L^T| over the lower triangle
+double residual(const TiledMatrix& original, const TiledMatrix& L) {
+    const int n = L.T * L.nb;
+    double max_err = 0.0;
+    for (int r = 0; r < n; ++r) {
+        for (int c = 0; c <= r; ++c) {
+            double s = 0.0;
+            for (int k = 0; k <= c; ++k) s += L.get(r, k) * L.get(c, k);
+            max_err = max(max_err, fabs(s - original.get(r, c)));
+        }
+    }
+    return max_err;
+}
+
+bool same_factor(const TiledMatrix& a, const TiledMatrix& b) {
+    const int n = a.T * a.nb;
+    for (int r = 0; r < n; ++r) {
+        for (int c = 0; c <= r; ++c) {
+            if (fabs(a.get(r, c) - b.get(r, c)) > 1e-9 * (1.0 + fabs(a.get(r, c)))) return false;
+        }
+    }
+    return true;
+}
+
+// Non-interactive benchmark mode (see Benchmark/bench.h). Sizes are the
+// number of tiles per dimension. Every repetition first restores the input
+// matrix, in all three variants (O(n^2) against the O(n^3) factorisation).
+int run_benchmark(const bench::Options& opt) {
+    auto known = bench::Suite::common_options();
+    known.insert("tile");
+    opt.check_known(known);
+    if (opt.has("help")) {
+        cout << "Usage: tiled_cholesky [options]   (no options: interactive)\n"
+             << "  --tile=N          tile size (default 64)\n";
+        bench::Suite::print_common_help();
+        return 0;
+    }
+
+    bench::Suite suite("tiled_cholesky", opt, {12}, "tiles", "seq", 3.0); // T^3 tile operations
+    const int tile_size = (int)opt.get_int("tile", 64);
+    if (tile_size <= 0) opt.error("--tile must be positive");
+    if (opt.report_errors()) return 1;
+
+    for (long long base : suite.sizes()) {
+        long long built = -1;
+        TiledMatrix original(1, tile_size), L_seq(1, tile_size);
+        for (int threads : suite.threads()) {
+            const int T = (int)suite.size_for(base, threads);
+            if (T != built) {
+                original = generate_spd(T, tile_size);
+                L_seq = original;
+                suite.add("seq", base, T, 1, suite.measure([&] {
+                    copy_values(L_seq, original);
+                    cholesky_seq(L_seq);
+                }), true);
+                built = T;
+            }
+            omp_set_num_threads(threads);
+            TiledMatrix L_fj = original;
+            bench::Stats stats = suite.measure([&] {
+                copy_values(L_fj, original);
+                cholesky_fork_join(L_fj);
+            });
+            suite.add("fork_join", base, T, threads, stats, same_factor(L_seq, L_fj));
+
+            // Built once, outside the timed region, and re-run by every repetition
+            TiledMatrix L_dag = original;
+            tg::TaskGraph graph;
+            build_cholesky_graph(graph, L_dag);
+            stats = suite.measure([&] {
+                copy_values(L_dag, original);
+                graph.run(threads);
+            });
+            suite.add("dag", base, T, threads, stats, same_factor(L_seq, L_dag));
+        }
+    }
+    return suite.finish();
+}
+
+int main(int argc, char* argv[]) {
+    bench::Options opt(argc, argv);
+    if (!opt.interactive()) return run_benchmark(opt);
+
+    int tiles_per_dim;
+    int tile_size;
+    int iterations;
+    int num_threads;
+
+    cout << "TILED CHOLESKY: TASK GRAPH VS FORK/JOIN\n";
+    cout << "=======================================\n\n";
+
+    cout << "Enter number of tiles per dimension: ";
+    cin >> tiles_per_dim;
+    cout << "Enter tile size: ";
+    cin >> tile_size;
+    cout << "Enter number of iterations (graph reuse): ";
+    cin >> iterations;
+    cout << "Enter number of threads to use (0 for auto): ";
+    cin >> num_threads;
+
+    if (tiles_per_dim <= 0 || tile_size <= 0 || iterations <= 0) {
+        cerr << "Error: Tiles, tile size and iterations must be positive!\n";
+        return 1;
+    }
+
+    if (num_threads > 0) {
+        omp_set_num_threads(num_threads);
+    } else {
+        num_threads = omp_get_max_threads();
+    }
+
+    const int n = tiles_per_dim * tile_size;
+    cout << "\nFactorising " << n << "x" << n << " matrix as " << tiles_per_dim << "x" << tiles_per_dim
+         << " tiles of " << tile_size << "x" << tile_size << "...\n";
+    const TiledMatrix original = generate_spd(tiles_per_dim, tile_size);
+
+    // Sequential
+    TiledMatrix L_seq = original;
+    auto start = high_resolution_clock::now();
+    cholesky_seq(L_seq);
+    auto seq_time = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+
+    // Fork/join, averaged over the iterations
+    TiledMatrix L_fj = original;
+    long long fj_total = 0;
+    for (int it = 0; it < iterations; ++it) {
+        L_fj = original;
+        start = high_resolution_clock::now();
+        cholesky_fork_join(L_fj);
+        fj_total += duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+    }
+
+    // Task graph: built once, then reused for every iteration
+    TiledMatrix L_dag = original;
+    tg::TaskGraph graph;
+    start = high_resolution_clock::now();
+    build_cholesky_graph(graph, L_dag);
+    auto build_time = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+
+    long long dag_total = 0;
+    double utilization = 0.0;
+    for (int it = 0; it < iterations; ++it) {
+        // Copy values in place: the graph's tasks hold pointers into L_dag
+        copy_values(L_dag, original);
+        start = high_resolution_clock::now();
+        graph.run(num_threads);
+        dag_total += duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+        utilization += graph.last_utilization();
+    }
+
+    const double fj_time = (double)fj_total / iterations;
+    const double dag_time = (double)dag_total / iterations;
+
+    cout << "\nResults:";
+    cout << "\nThreads: " << num_threads;
+    cout << "\nTasks: " << graph.size() << ", dependencies: " << graph.num_edges();
+    cout << fixed << setprecision(2);
+    cout << "\nAvailable parallelism (total cost / critical path): " << graph.total_cost() / graph.critical_path();
+    cout << "\nSequential time: " << seq_time << " μs";
+    cout << "\nFork/join time: " << fj_time << " μs (avg of " << iterations << ")";
+    cout << "\nTask graph time: " << dag_time << " μs (avg of " << iterations << ", built once in " << build_time << " μs)";
+    cout << "\nTask graph utilization: " << 100.0 * utilization / iterations << "%";
+    if (dag_time > 0) {
+        cout << "\nTask graph gain over fork/join: " << fj_time / dag_time << "x";
+    }
+    cout << "\nFactor matches sequential: " << (same_factor(L_seq, L_fj) && same_factor(L_seq, L_dag) ? "Yes" : "No");
+    if (n <= 1024) {
+        cout << scientific << setprecision(2) << "\nResidual max|A - LL^T|: " << residual(original, L_dag);
+    }
+    cout << endl;
+
+    return 0;
+}
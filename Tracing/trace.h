@@ -0,0 +1,176 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Low-overhead per-thread tracing with Chrome / Perfetto JSON export.
+//
+// Compile with -DPARALLEL_TRACE to enable; otherwise every macro expands to
+// nothing and the instrumented code is unchanged.
+//
+//   TRACE_ZONE("bfs_level");              // scoped: records begin/end
+//   TRACE_COUNTER("frontier_size", n);    // counter track
+//   trace::write_chrome_json("trace.json");
+//
+// Each thread appends to its own fixed-size ring buffer (single writer, no
+// locks; the oldest events are overwritten when it is full). Only the first
+// event of a thread takes a lock, to register its buffer. Zone names must be
+// string literals since only the pointer is stored. Export after the traced
+// parallel work has finished and open the file in chrome://tracing or
+// https://ui.perfetto.dev.
+//
+// Timestamps come from steady_clock, or from the TSC with
+// -DPARALLEL_TRACE_RDTSC (cheaper, converted to ns at export time).
+
+#ifdef PARALLEL_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef PARALLEL_TRACE_RDTSC
+#include <x86intrin.h>
+#endif
+
+#ifndef PARALLEL_TRACE_CAPACITY
+#define PARALLEL_TRACE_CAPACITY (1 << 18) // events per thread
+#endif
+
+namespace trace {
+
+struct Event {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;     // zones only
+    int64_t value;    // counters only
+    bool is_counter;
+};
+
+struct ThreadBuffer {
+    explicit ThreadBuffer(int id) : tid(id), head(0), events(new Event[PARALLEL_TRACE_CAPACITY]) {}
+
+    int tid;
+    std::atomic<uint64_t> head; // total events ever written
+    std::unique_ptr<Event[]> events;
+
+    void push(const Event& e) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        events[h % PARALLEL_TRACE_CAPACITY] = e;
+        head.store(h + 1, std::memory_order_release);
+    }
+};
+
+inline uint64_t steady_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline uint64_t now() {
+#ifdef PARALLEL_TRACE_RDTSC
+    return __rdtsc();
+#else
+    return steady_ns();
+#endif
+}
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers; // kept until exit
+    uint64_t start_ticks = now();
+    uint64_t start_ns = steady_ns();
+
+    static Registry& get() {
+        static Registry registry;
+        return registry;
+    }
+};
+
+inline ThreadBuffer& local_buffer() {
+    static thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        Registry& r = Registry::get();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.buffers.emplace_back(new ThreadBuffer((int)r.buffers.size()));
+        buffer = r.buffers.back().get();
+    }
+    return *buffer;
+}
+
+class Zone {
+public:
+    explicit Zone(const char* name) : buffer_(local_buffer()), name_(name), begin_(now()) {}
+    ~Zone() { buffer_.push({name_, begin_, now(), 0, false}); }
+
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+
+private:
+    ThreadBuffer& buffer_;
+    const char* name_;
+    uint64_t begin_;
+};
+
+inline void counter(const char* name, int64_t value) {
+    uint64_t t = now();
+    local_buffer().push({name, t, t, value, true});
+}
+
+// Writes every recorded event as Chrome trace JSON; returns false on I/O error
+inline bool write_chrome_json(const std::string& path) {
+    Registry& r = Registry::get();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    // Ticks -> microseconds since the registry was created
+    double us_per_tick = 1e-3;
+#ifdef PARALLEL_TRACE_RDTSC
+    uint64_t ticks = now() - r.start_ticks;
+    uint64_t ns = steady_ns() - r.start_ns;
+    if (ticks > 0) us_per_tick = (double)ns / ticks * 1e-3;
+#endif
+    auto to_us = [&](uint64_t t) { return t >= r.start_ticks ? (t - r.start_ticks) * us_per_tick : 0.0; };
+
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto& buffer : r.buffers) {
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+                first ? "" : ",\n", buffer->tid, buffer->tid);
+        first = false;
+
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        const uint64_t begin = head > PARALLEL_TRACE_CAPACITY ? head - PARALLEL_TRACE_CAPACITY : 0;
+        for (uint64_t i = begin; i < head; ++i) {
+            const Event& e = buffer->events[i % PARALLEL_TRACE_CAPACITY];
+            if (e.is_counter) {
+                fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":0,\"tid\":%d,\"args\":{\"value\":%lld}}",
+                        e.name, to_us(e.begin), buffer->tid, (long long)e.value);
+            } else {
+                fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d}",
+                        e.name, to_us(e.begin), (e.end - e.begin) * us_per_tick, buffer->tid);
+            }
+        }
+    }
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0;
+}
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_ZONE(name) trace::Zone TRACE_CONCAT(trace_zone_, __LINE__)(name)
+#define TRACE_COUNTER(name, value) trace::counter(name, (int64_t)(value))
+
+#else
+
+#define TRACE_ZONE(name) ((void)0)
+#define TRACE_COUNTER(name, value) ((void)0)
+
+#endif // PARALLEL_TRACE
+
+#endif // TRACE_H
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <vector>
+#include <omp.h>
+#include <chrono>
+#include <iomanip>
+#include <atomic>
+#include <string>
+#include "work_stealing.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// Binary tree used by the tree-sum benchmark
+struct TreeNode {
+    long value;
+    TreeNode* left;
+    TreeNode* right;
+};
+
+TreeNode* build_tree(int depth, long& next_value) {
+    if (depth == 0) return nullptr;
+    TreeNode* node = new TreeNode{next_value++, nullptr, nullptr};
+    node->left = build_tree(depth - 1, next_value);
+    node->right = build_tree(depth - 1, next_value);
+    return node;
+}
+
+void free_tree(TreeNode* node) {
+    if (!node) return;
+    free_tree(node->left);
+    free_tree(node->right);
+    delete node;
+}
+
+// Fibonacci with one task per call (no cutoff, measures scheduling overhead)
+long fib_seq(int n) {
+    if (n < 2) return n;
+    return fib_seq(n - 1) + fib_seq(n - 2);
+}
+
+long fib_omp(int n) {
+    if (n < 2) return n;
+    long x, y;
+    #pragma omp task shared(x)
+    x = fib_omp(n - 1);
+    y = fib_omp(n - 2);
+    #pragma omp taskwait
+    return x + y;
+}
+
+long fib_ws(int n) {
+    if (n < 2) return n;
+    long x, y;
+    ws::TaskGroup g;
+    g.spawn([&x, n] { x = fib_ws(n - 1); });
+    y = fib_ws(n - 2);
+    g.sync();
+    return x + y;
+}
+
+// Tree sum with one task per subtree
+long tree_sum_seq(const TreeNode* node) {
+    if (!node) return 0;
+    return node->value + tree_sum_seq(node->left) + tree_sum_seq(node->right);
+}
+
+long tree_sum_omp(const TreeNode* node) {
+    if (!node) return 0;
+    long l, r;
+    #pragma omp task shared(l)
+    l = tree_sum_omp(node->left);
+    r = tree_sum_omp(node->right);
+    #pragma omp taskwait
+    return node->value + l + r;
+}
+
+long tree_sum_ws(const TreeNode* node) {
+    if (!node) return 0;
+    long l, r;
+    ws::TaskGroup g;
+    g.spawn([&l, node] { l = tree_sum_ws(node->left); });
+    r = tree_sum_ws(node->right);
+    g.sync();
+    return node->value + l + r;
+}
+
+// Times f in microseconds
+template <typename F>
+long long time_us(F&& f) {
+    auto start = high_resolution_clock::now();
+    f();
+    auto stop = high_resolution_clock::now();
+    return duration_cast<microseconds>(stop - start).count();
+}
+
+void print_row(const string& name, long long omp_us, long long ws_us, bool match) {
+    cout << left << setw(16) << name << right
+         << setw(12) << omp_us << setw(12) << ws_us;
+    if (ws_us > 0) {
+        cout << setw(10) << fixed << setprecision(2) << (double)omp_us / ws_us << "x";
+    } else {
+        cout << setw(11) << "n/a";
+    }
+    cout << "   " << (match ? "Yes" : "No") << "\n";
+}
+
+int main() {
+    int num_threads;
+    int fib_n;
+    int tree_depth;
+    int num_tasks;
+    int pin;
+
+    cout << "WORK-STEALING TASK MICROBENCHMARK\n";
+    cout << "=================================\n\n";
+
+    cout << "Enter number of threads to use (0 for auto): ";
+    cin >> num_threads;
+    cout << "Enter Fibonacci n (e.g. 27): ";
+    cin >> fib_n;
+    cout << "Enter tree depth (e.g. 20): ";
+    cin >> tree_depth;
+    cout << "Enter number of empty tasks to spawn (e.g. 1000000): ";
+    cin >> num_tasks;
+    cout << "Pin workers to CPUs? (1 = yes, 0 = no): ";
+    cin >> pin;
+
+    if (fib_n < 0 || tree_depth < 0 || tree_depth > 28 || num_tasks <= 0) {
+        cerr << "Error: need fib n >= 0, 0 <= tree depth <= 28 and tasks > 0!\n";
+        return 1;
+    }
+
+    if (num_threads > 0) {
+        omp_set_num_threads(num_threads);
+    } else {
+        num_threads = omp_get_max_threads();
+    }
+
+    ws::ThreadPool pool(num_threads, pin != 0);
+
+    long next_value = 1;
+    TreeNode* tree = build_tree(tree_depth, next_value);
+
+    cout << "\nThreads: " << num_threads << (pin ? " (workers pinned)" : "") << "\n\n";
+    cout << left << setw(16) << "Benchmark" << right
+         << setw(12) << "OpenMP(us)" << setw(12) << "WS(us)"
+         << setw(11) << "WS gain" << "   Match\n";
+    cout << string(62, '-') << "\n";
+
+    // fib: deep recursion of tiny tasks
+    long fib_expected = fib_seq(fib_n);
+    long fib_o = 0, fib_w = 0;
+    long long t_omp = time_us([&] {
+        #pragma omp parallel
+        #pragma omp single
+        fib_o = fib_omp(fib_n);
+    });
+    long long t_ws = time_us([&] { pool.run([&] { fib_w = fib_ws(fib_n); }); });
+    print_row("fib(" + to_string(fib_n) + ")", t_omp, t_ws, fib_o == fib_expected && fib_w == fib_expected);
+
+    // tree-sum: pointer chasing, one task per subtree
+    long sum_expected = tree_sum_seq(tree);
+    long sum_o = 0, sum_w = 0;
+    t_omp = time_us([&] {
+        #pragma omp parallel
+        #pragma omp single
+        sum_o = tree_sum_omp(tree);
+    });
+    t_ws = time_us([&] { pool.run([&] { sum_w = tree_sum_ws(tree); }); });
+    print_row("tree-sum(" + to_string(tree_depth) + ")", t_omp, t_ws, sum_o == sum_expected && sum_w == sum_expected);
+
+    // spawn rate: one producer spawning empty tasks
+    atomic<long> ran_o(0), ran_w(0);
+    t_omp = time_us([&] {
+        #pragma omp parallel
+        #pragma omp single
+        {
+            for (int i = 0; i < num_tasks; ++i) {
+                #pragma omp task
+                ran_o.fetch_add(1, memory_order_relaxed);
+            }
+            #pragma omp taskwait
+        }
+    });
+    t_ws = time_us([&] {
+        pool.run([&] {
+            ws::TaskGroup g;
+            for (int i = 0; i < num_tasks; ++i) {
+                g.spawn([&ran_w] { ran_w.fetch_add(1, memory_order_relaxed); });
+            }
+            g.sync();
+        });
+    });
+    print_row("spawn", t_omp, t_ws, ran_o == num_tasks && ran_w == num_tasks);
+    if (t_omp > 0 && t_ws > 0) {
+        cout << "  spawn rate: OpenMP " << fixed << setprecision(2) << num_tasks / (double)t_omp
+             << " Mtasks/s, WS " << num_tasks / (double)t_ws << " Mtasks/s\n";
+    }
+
+    // parallel_for: uneven iterations, adaptive splitting vs static schedule
+    const int n = 1 << 20;
+    vector<double> a(n), b(n);
+    auto body = [](int i) {
+        double x = i;
+        int work = (i % 1024 == 0) ? 2000 : 4;
+        for (int k = 0; k < work; ++k) x = x * 0.999 + 1.0;
+        return x;
+    };
+    t_omp = time_us([&] {
+        #pragma omp parallel for
+        for (int i = 0; i < n; ++i) a[i] = body(i);
+    });
+    t_ws = time_us([&] { ws::parallel_for(pool, 0, n, [&](int64_t i) { b[i] = body((int)i); }); });
+    print_row("parallel_for", t_omp, t_ws, a == b);
+
+    free_tree(tree);
+    return 0;
+}
@@ -0,0 +1,463 @@
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+// Work-stealing thread pool.
+//
+// Every worker owns a Chase-Lev deque: it pushes and pops spawned tasks at
+// the bottom (LIFO, good locality) while idle workers steal from the top
+// (FIFO, oldest and usually largest tasks). Tasks submitted from threads
+// outside the pool go through a small locked injection queue.
+//
+// spawn is help-first (child stealing): the child is queued and the parent
+// continues. Work-first (continuation stealing, as in Cilk) would need the
+// parent's stack frame to be resumable by a thief, which takes compiler or
+// coroutine support that a library cannot provide. As a consequence, a
+// loop that spawns without syncing grows the deque by one task per spawn,
+// until it holds SPAWN_CUTOFF tasks; from then on children run inline.
+// Split ranges recursively (as parallel_for does) to keep it at O(depth).
+//
+//   ws::ThreadPool pool(4);
+//   pool.run([&] {
+//       ws::TaskGroup g;
+//       g.spawn([&] { left(); });
+//       right();
+//       g.sync();            // helps with other tasks while waiting
+//   });
+//   ws::parallel_for(pool, 0, n, [&](int64_t i) { ... });
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ws {
+
+class TaskGroup;
+class ThreadPool;
+
+// TaskGroup::spawn runs the child inline once the calling worker's deque
+// holds this many tasks (libgomp does the same for omp task)
+const int64_t SPAWN_CUTOFF = 256;
+
+// Unit of work; owned by the pool once spawned
+class Task {
+public:
+    virtual ~Task() {}
+    virtual void run() = 0;
+    TaskGroup* group = nullptr;
+};
+
+template <typename F>
+class FunctionTask : public Task {
+public:
+    explicit FunctionTask(F&& f) : f_(std::move(f)) {}
+    void run() override { f_(); }
+private:
+    F f_;
+};
+
+// Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli, PPoPP'13).
+// push/pop are called by the owner only, steal by any thread.
+class Deque {
+public:
+    explicit Deque(int64_t capacity = 256) : top_(0), bottom_(0), array_(new Array(capacity)) {}
+
+    ~Deque() {
+        delete array_.load(std::memory_order_relaxed);
+        for (Array* a : retired_) delete a;
+    }
+
+    Deque(const Deque&) = delete;
+    Deque& operator=(const Deque&) = delete;
+
+    void push(Task* task) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) {
+            a = grow(a, t, b);
+        }
+        a->put(b, task);
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    Task* pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // Deque was empty
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Task* task = a->get(b);
+        if (t == b) {
+            // Last element: race against thieves for it
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                task = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    Task* steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        Array* a = array_.load(std::memory_order_acquire);
+        Task* task = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr; // Lost the race to the owner or another thief
+        }
+        return task;
+    }
+
+    // Approximate size; exact only when called by the owner with no thieves
+    int64_t size() const {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+private:
+    struct Array {
+        int64_t capacity;
+        std::unique_ptr<std::atomic<Task*>[]> slots;
+
+        explicit Array(int64_t cap) : capacity(cap), slots(new std::atomic<Task*>[cap]) {}
+        Task* get(int64_t i) const { return slots[i & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(int64_t i, Task* task) { slots[i & (capacity - 1)].store(task, std::memory_order_relaxed); }
+    };
+
+    Array* grow(Array* old, int64_t t, int64_t b) {
+        Array* a = new Array(old->capacity * 2);
+        for (int64_t i = t; i < b; ++i) a->put(i, old->get(i));
+        // Thieves may still read the old array, so keep it until destruction
+        retired_.push_back(old);
+        array_.store(a, std::memory_order_release);
+        return a;
+    }
+
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+    std::atomic<Array*> array_;
+    std::vector<Array*> retired_;
+};
+
+class ThreadPool {
+public:
+    // num_threads <= 0 uses every hardware thread; pin binds worker i to the
+    // i-th CPU the process may run on (see sched_getaffinity)
+    explicit ThreadPool(int num_threads = 0, bool pin = false) : stop_(false), sleeping_(0), injected_count_(0) {
+        if (num_threads <= 0) num_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 0; i < num_threads; ++i) {
+            workers_.emplace_back(new Worker());
+            workers_.back()->rng = 0x9E3779B97F4A7C15ull * (i + 1);
+        }
+        // Read before any worker is pinned: the workers inherit this thread's mask
+        const std::vector<int> cpus = pin ? allowed_cpus() : std::vector<int>();
+        for (int i = 0; i < num_threads; ++i) {
+            const int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+            workers_[i]->thread = std::thread([this, i, cpu] {
+                if (cpu >= 0) pin_to_cpu(cpu);
+                worker_loop(i);
+            });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_.store(true);
+        }
+        sleep_cv_.notify_all();
+        for (auto& w : workers_) w->thread.join();
+        // Tasks never run, e.g. spawned without a matching sync
+        for (auto& w : workers_) {
+            while (Task* task = w->deque.pop()) delete task;
+        }
+        for (Task* task : injected_) delete task;
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return (int)workers_.size(); }
+
+    // Pool the calling thread works for, or nullptr outside any pool
+    static ThreadPool* current() { return tls().pool; }
+
+    // Index of the calling worker, or -1 outside the pool
+    int worker_id() const { return tls().pool == this ? tls().id : -1; }
+
+    // Runs f on a worker and blocks until it (and everything it synced) is done
+    template <typename F>
+    void run(F&& f) {
+        if (worker_id() >= 0) {
+            f();
+            return;
+        }
+        std::mutex m;
+        std::condition_variable cv;
+        bool done = false;
+        submit(make_task([&] {
+            f();
+            std::lock_guard<std::mutex> lock(m);
+            done = true;
+            cv.notify_one();
+        }));
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&] { return done; });
+    }
+
+    // Queues a task: on the caller's deque for workers, otherwise injected
+    void submit(Task* task) {
+        int id = worker_id();
+        if (id >= 0) {
+            workers_[id]->deque.push(task);
+        } else {
+            std::lock_guard<std::mutex> lock(inject_mutex_);
+            injected_.push_back(task);
+            injected_count_.fetch_add(1, std::memory_order_release);
+        }
+        if (sleeping_.load(std::memory_order_relaxed) > 0) sleep_cv_.notify_one();
+    }
+
+    // Runs one pending task if any can be found; used by waiting threads
+    bool try_run_one() {
+        int id = worker_id();
+        Task* task = id >= 0 ? find_task(id) : take_injected();
+        if (!task) return false;
+        execute(task);
+        return true;
+    }
+
+    // Number of tasks in the calling worker's own deque (0 outside the pool)
+    int64_t local_queue_size() const {
+        int id = worker_id();
+        return id >= 0 ? workers_[id]->deque.size() : 0;
+    }
+
+    template <typename F>
+    static Task* make_task(F&& f) {
+        return new FunctionTask<typename std::decay<F>::type>(std::forward<F>(f));
+    }
+
+    inline void execute(Task* task);
+
+private:
+    struct alignas(64) Worker {
+        Deque deque;
+        std::thread thread;
+        uint64_t rng = 0;
+    };
+
+    struct ThreadState {
+        ThreadPool* pool = nullptr;
+        int id = -1;
+    };
+
+    static ThreadState& tls() {
+        static thread_local ThreadState state;
+        return state;
+    }
+
+    // CPUs in the calling thread's affinity mask, in order; empty when
+    // unknown. Honours taskset and cpuset cgroups, unlike hardware_concurrency.
+    static std::vector<int> allowed_cpus() {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int c = 0; c < CPU_SETSIZE; ++c) {
+                if (CPU_ISSET(c, &set)) cpus.push_back(c);
+            }
+        }
+#endif
+        return cpus;
+    }
+
+    static void pin_to_cpu(int cpu) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)cpu;
+#endif
+    }
+
+    Task* take_injected() {
+        if (injected_count_.load(std::memory_order_acquire) == 0) return nullptr;
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        if (injected_.empty()) return nullptr;
+        Task* task = injected_.front();
+        injected_.pop_front();
+        injected_count_.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
+
+    // Own deque first, then random victims, then the injection queue
+    Task* find_task(int id) {
+        Worker& self = *workers_[id];
+        if (Task* task = self.deque.pop()) return task;
+
+        const int n = size();
+        for (int attempt = 0; attempt < 2 * n; ++attempt) {
+            // xorshift64
+            self.rng ^= self.rng << 13;
+            self.rng ^= self.rng >> 7;
+            self.rng ^= self.rng << 17;
+            int victim = (int)(self.rng % n);
+            if (victim == id) continue;
+            if (Task* task = workers_[victim]->deque.steal()) return task;
+        }
+        return take_injected();
+    }
+
+    void worker_loop(int id) {
+        tls().pool = this;
+        tls().id = id;
+
+        int idle_rounds = 0;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            if (Task* task = find_task(id)) {
+                execute(task);
+                idle_rounds = 0;
+                continue;
+            }
+            if (++idle_rounds < 64) {
+                std::this_thread::yield();
+                continue;
+            }
+            // Nothing to do for a while: sleep until new work is submitted.
+            // The timeout covers the window between the check and the wait.
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleeping_.fetch_add(1);
+            sleep_cv_.wait_for(lock, std::chrono::milliseconds(1));
+            sleeping_.fetch_sub(1);
+            idle_rounds = 0;
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<bool> stop_;
+
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    std::atomic<int> sleeping_;
+
+    std::mutex inject_mutex_;
+    std::deque<Task*> injected_;
+    std::atomic<int> injected_count_;
+};
+
+// Fork/join scope: spawn() children, sync() waits for all of them while the
+// waiting thread keeps executing other tasks instead of blocking. spawn is
+// help-first: the child is queued and the caller carries on.
+class TaskGroup {
+public:
+    // Uses the pool of the calling worker; must be called inside ThreadPool::run
+    TaskGroup() : TaskGroup(*ThreadPool::current()) {}
+    explicit TaskGroup(ThreadPool& pool) : pool_(pool), pending_(0) {}
+
+    ~TaskGroup() { sync(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename F>
+    void spawn(F&& f) {
+        // Cutoff: with this many tasks already queued for thieves, one more
+        // adds nothing but allocation and deque traffic, so run it now
+        if (pool_.local_queue_size() >= SPAWN_CUTOFF) {
+            f();
+            return;
+        }
+        Task* task = ThreadPool::make_task(std::forward<F>(f));
+        task->group = this;
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        pool_.submit(task);
+    }
+
+    void sync() {
+        while (pending_.load(std::memory_order_acquire) > 0) {
+            if (!pool_.try_run_one()) std::this_thread::yield();
+        }
+    }
+
+    ThreadPool& pool() { return pool_; }
+
+private:
+    friend class ThreadPool;
+    ThreadPool& pool_;
+    std::atomic<int64_t> pending_;
+};
+
+inline void ThreadPool::execute(Task* task) {
+    task->run();
+    TaskGroup* group = task->group;
+    delete task;
+    if (group) group->pending_.fetch_sub(1, std::memory_order_release);
+}
+
+namespace detail {
+
+// Lazy binary splitting: a range is only split in half while the worker's
+// own deque is empty, i.e. when there is nothing left for thieves to take.
+// Otherwise a grain-sized piece is run directly, so splitting adapts to the
+// actual load instead of creating a fixed number of tasks.
+template <typename F>
+void for_range(TaskGroup& group, int64_t begin, int64_t end, int64_t grain, const F& f) {
+    ThreadPool& pool = group.pool();
+    while (end - begin > grain) {
+        if (pool.local_queue_size() == 0) {
+            int64_t mid = begin + (end - begin) / 2;
+            group.spawn([&group, mid, end, grain, &f] { for_range(group, mid, end, grain, f); });
+            end = mid;
+        } else {
+            for (int64_t i = begin; i < begin + grain; ++i) f(i);
+            begin += grain;
+        }
+    }
+    for (int64_t i = begin; i < end; ++i) f(i);
+}
+
+} // namespace detail
+
+// Calls f(i) for i in [begin, end); grain <= 0 picks one automatically
+template <typename F>
+void parallel_for(ThreadPool& pool, int64_t begin, int64_t end, const F& f, int64_t grain = 0) {
+    if (end <= begin) return;
+    if (grain <= 0) grain = std::max<int64_t>(1, (end - begin) / (32 * (int64_t)pool.size()));
+    pool.run([&] {
+        TaskGroup group(pool);
+        detail::for_range(group, begin, end, grain, f);
+        group.sync();
+    });
+}
+
+} // namespace ws
+
+#endif // WORK_STEALING_H